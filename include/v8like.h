@@ -38,6 +38,14 @@
 #include <vector>
 #include <map>
 
+// rvalue paths let a reference be handed along instead of counted again
+#if __cplusplus >= 201103L
+#include <utility>
+#define V8LIKE_MOVE(x) std::move(x)
+#else
+#define V8LIKE_MOVE(x) (x)
+#endif
+
 #ifdef _WIN32
 
 #if defined(BUILDING_V8_SHARED) && defined(USING_V8_SHARED)
@@ -212,6 +220,12 @@ public:
 	virtual void DecRef();
 	unsigned int GetRef() const { return m_ref; }
 
+private:
+	static size_t sm_inc_ref_count; // all IncRef calls, for measuring handle traffic
+
+public:
+	static size_t GetIncRefCount() { return sm_inc_ref_count; }
+
 public:
 	virtual void _OnCreate() {}
 	virtual void _OnDelete() {}
@@ -232,20 +246,32 @@ template <class T> class SmartPointer
 {
 private:
 	T* m_ptr; // the managed pointer (derived from SmartObject)
+	bool m_is_borrowed; // reference is held elsewhere (by a HandleScope), so no counting
 
 public:
 	// construction and destruction
-	SmartPointer(T* ptr = (T*) 0) : m_ptr(ptr)
+	SmartPointer(T* ptr = (T*) 0) : m_ptr(ptr), m_is_borrowed(false)
 	{
 		if (m_ptr) { m_ptr->IncRef(); }
 	}
-	SmartPointer(const SmartPointer& other) : m_ptr(other.m_ptr)
+	SmartPointer(T* ptr, bool is_borrowed) : m_ptr(ptr), m_is_borrowed(is_borrowed)
+	{
+		if (m_ptr && !m_is_borrowed) { m_ptr->IncRef(); }
+	}
+	SmartPointer(const SmartPointer& other) : m_ptr(other.m_ptr), m_is_borrowed(false)
 	{
 		if (m_ptr) { m_ptr->IncRef(); }
 	}
+	#if __cplusplus >= 201103L
+	SmartPointer(SmartPointer&& other) : m_ptr((T*) 0), m_is_borrowed(false)
+	{
+		_Take(other, false);
+	}
+	#endif
 	virtual ~SmartPointer()
 	{
-		if (m_ptr) { m_ptr->DecRef(); m_ptr = (T*) 0; }
+		if (m_ptr && !m_is_borrowed) { m_ptr->DecRef(); }
+		m_ptr = (T*) 0;
 	}
 
 	// implicit conversions
@@ -256,24 +282,25 @@ public:
 	// assignment
 	SmartPointer& operator=(T* ptr)
 	{
-		if (m_ptr != ptr)
-		{
-			if (m_ptr) { m_ptr->DecRef(); }
-			m_ptr = ptr;
-			if (m_ptr) { m_ptr->IncRef(); }
-		}
+		_Reset(ptr, false);
 		return *this;
 	}
 	SmartPointer& operator=(const SmartPointer& other)
 	{
-		if (m_ptr != other.m_ptr)
+		// stays borrowed only when both sides are; otherwise take a counted reference
+		_Reset(other.m_ptr, m_is_borrowed && other.m_is_borrowed);
+		return *this;
+	}
+	#if __cplusplus >= 201103L
+	SmartPointer& operator=(SmartPointer&& other)
+	{
+		if (this != &other)
 		{
-			if (m_ptr) { m_ptr->DecRef(); }
-			m_ptr = other.m_ptr;
-			if (m_ptr) { m_ptr->IncRef(); }
+			_Take(other, m_is_borrowed);
 		}
 		return *this;
 	}
+	#endif
 
 	// comparisons
 	bool operator==(T* ptr) const { return (m_ptr == ptr); }
@@ -283,7 +310,55 @@ public:
 
 	T* GetPointer() const { return m_ptr; }
 	bool IsEmpty() const { return (m_ptr == ((T*) 0)); }
-	void _Clear() { if (m_ptr) { m_ptr->DecRef(); m_ptr = (T*) 0; } }
+	bool _IsBorrowed() const { return m_is_borrowed; }
+	void _Clear() { _Reset((T*) 0, false); }
+
+	// steals the reference held by other; a borrowed one is kept borrowed if allowed, else counted
+	void _Take(SmartPointer& other, bool may_borrow)
+	{
+		if (other.m_is_borrowed)
+		{
+			_Reset(other.m_ptr, may_borrow);
+			return;
+		}
+		T* old_ptr = m_ptr;
+		bool old_is_borrowed = m_is_borrowed;
+		m_ptr = other.m_ptr;
+		m_is_borrowed = false;
+		other.m_ptr = (T*) 0;
+		if (old_ptr && !old_is_borrowed) { old_ptr->DecRef(); }
+	}
+	// hands out the reference held, counting it first if it was borrowed
+	T* _Release()
+	{
+		T* ptr = m_ptr;
+		if (ptr && m_is_borrowed) { ptr->IncRef(); }
+		m_ptr = (T*) 0;
+		m_is_borrowed = false;
+		return ptr;
+	}
+	// takes over a reference already counted for us
+	void _Acquire(T* ptr)
+	{
+		T* old_ptr = m_ptr;
+		bool old_is_borrowed = m_is_borrowed;
+		m_ptr = ptr;
+		m_is_borrowed = false;
+		if (old_ptr && !old_is_borrowed) { old_ptr->DecRef(); }
+	}
+	// the counted reference now belongs to a HandleScope
+	void _Lend() { m_is_borrowed = true; }
+
+private:
+	void _Reset(T* ptr, bool is_borrowed)
+	{
+		T* old_ptr = m_ptr;
+		bool old_is_borrowed = m_is_borrowed;
+		m_ptr = ptr;
+		m_is_borrowed = is_borrowed;
+		if (m_ptr && !m_is_borrowed) { m_ptr->IncRef(); }
+		if (old_ptr && !old_is_borrowed) { old_ptr->DecRef(); }
+	}
 };
 
 class JSStringWrap
@@ -315,10 +390,245 @@ public:
 	}
 };
 
+/// v8::internal::PointerMap<T>
+
+// open-addressed map from an opaque JSC pointer to a wrapper; values are not counted
+template <class T> class PointerMap
+{
+private:
+	class Entry
+	{
+	public:
+		const void* m_key; // NULL for an empty slot
+		T* m_value;
+	public:
+		Entry() : m_key(NULL), m_value(NULL) {}
+	};
+
+	std::vector<Entry> m_entry_array; // linear probing, power-of-two size
+	size_t m_count;
+
+private:
+	size_t GetIndex(const void* key) const
+	{
+		return ((((uintptr_t) key) >> 3) * 2654435761u) & (m_entry_array.size() - 1);
+	}
+	void Grow()
+	{
+		std::vector<Entry> entry_array(m_entry_array.size() * 2);
+		entry_array.swap(m_entry_array);
+		m_count = 0;
+		for (size_t i = 0; i < entry_array.size(); ++i)
+		{
+			if (entry_array[i].m_key != NULL)
+			{
+				Insert(entry_array[i].m_key, entry_array[i].m_value);
+			}
+		}
+	}
+
+public:
+	PointerMap() : m_entry_array(64), m_count(0) {}
+
+	size_t GetCount() const { return m_count; }
+	size_t GetCapacity() const { return m_entry_array.size(); }
+	T* GetValueAt(size_t index) const { return m_entry_array[index].m_value; } // NULL for an empty slot
+
+	T* Find(const void* key) const
+	{
+		const size_t mask = m_entry_array.size() - 1;
+		for (size_t index = GetIndex(key); m_entry_array[index].m_key != NULL; index = (index + 1) & mask)
+		{
+			if (m_entry_array[index].m_key == key)
+			{
+				return m_entry_array[index].m_value;
+			}
+		}
+		return NULL;
+	}
+
+	void Insert(const void* key, T* value)
+	{
+		assert(key != NULL);
+		if ((m_count + 1) * 4 > m_entry_array.size() * 3)
+		{
+			Grow();
+		}
+		const size_t mask = m_entry_array.size() - 1;
+		size_t index = GetIndex(key);
+		while ((m_entry_array[index].m_key != NULL) && (m_entry_array[index].m_key != key))
+		{
+			index = (index + 1) & mask;
+		}
+		if (m_entry_array[index].m_key == NULL)
+		{
+			m_entry_array[index].m_key = key;
+			++m_count;
+		}
+		m_entry_array[index].m_value = value;
+	}
+
+	void Remove(const void* key)
+	{
+		const size_t mask = m_entry_array.size() - 1;
+		size_t index = GetIndex(key);
+		while (m_entry_array[index].m_key != key)
+		{
+			if (m_entry_array[index].m_key == NULL)
+			{
+				return; // not present
+			}
+			index = (index + 1) & mask;
+		}
+		// shift later members of the probe run back so lookups never stop early
+		size_t next = (index + 1) & mask;
+		while (m_entry_array[next].m_key != NULL)
+		{
+			size_t home = GetIndex(m_entry_array[next].m_key);
+			if (((next - home) & mask) >= ((next - index) & mask))
+			{
+				m_entry_array[index] = m_entry_array[next];
+				index = next;
+			}
+			next = (next + 1) & mask;
+		}
+		m_entry_array[index] = Entry();
+		--m_count;
+	}
+};
+
+/// v8::internal::SlabAllocator
+
+// size-class slab allocator backing v8::Data::operator new/delete
+class SlabAllocator
+{
+public:
+	static const size_t kGranularity = 16; // bytes between size classes
+	static const size_t kSizeClassCount = 16; // 16 .. 256 bytes
+	static const size_t kMaxSize = kGranularity * kSizeClassCount;
+	static const size_t kSlabSize = 16 * 1024;
+
+	class Stats
+	{
+	public:
+		size_t m_alloc_count; // blocks handed out
+		size_t m_free_count; // blocks returned
+		size_t m_reuse_count; // allocations served from a freelist
+		size_t m_live_count; // blocks currently in use
+		size_t m_slab_count; // slabs carved for this size class
+	public:
+		Stats() : m_alloc_count(0), m_free_count(0), m_reuse_count(0), m_live_count(0), m_slab_count(0) {}
+	};
+
+private:
+	class Block
+	{
+	public:
+		Block* m_next;
+	};
+
+	class SizeClass
+	{
+	public:
+		Block* m_free_list;
+		char* m_slab_cursor;
+		char* m_slab_limit;
+		Stats m_stats;
+	public:
+		SizeClass() : m_free_list(NULL), m_slab_cursor(NULL), m_slab_limit(NULL) {}
+	};
+
+	SizeClass m_size_class_array[kSizeClassCount];
+	Stats m_large_stats; // allocations above kMaxSize, forwarded to ::operator new
+	std::vector<void*> m_slab_array;
+
+private:
+	SlabAllocator() {}
+	~SlabAllocator() {}
+
+public:
+	void* Allocate(size_t size);
+	void Free(void* ptr, size_t size);
+
+	const Stats& GetStats(size_t size_class) const { return m_size_class_array[size_class].m_stats; }
+	const Stats& GetLargeStats() const { return m_large_stats; }
+	size_t GetReservedBytes() const { return m_slab_array.size() * kSlabSize; }
+	size_t GetUsedBytes() const;
+	void PrintStats(FILE* out) const;
+
+private:
+	static SlabAllocator* sm_instance;
+
+public:
+	static SlabAllocator* GetInstance();
+};
+
+/// v8::internal::ProtectJournal
+
+// defers JSValueUnprotect while a HandleScope is active so that a protect of
+// the same value before the flush cancels against it instead of reaching JSC
+class ProtectJournal
+{
+public:
+	static const size_t kInitialCapacity = 64; // slots, power of two
+	static const size_t kFlushThreshold = 256; // deferred unprotects before any scope exit flushes
+
+	class Stats
+	{
+	public:
+		size_t m_protect_count; // JSValueProtect calls made
+		size_t m_unprotect_count; // JSValueUnprotect calls made
+		size_t m_defer_count; // unprotects journaled instead of made
+		size_t m_cancel_count; // protects that consumed a journaled unprotect (two calls saved)
+		size_t m_flush_count; // flushes that had work to do
+	public:
+		Stats() : m_protect_count(0), m_unprotect_count(0), m_defer_count(0), m_cancel_count(0), m_flush_count(0) {}
+	};
+
+private:
+	class Entry
+	{
+	public:
+		JSValueRef m_js_value; // NULL for an empty slot
+		JSContextRef m_js_ctx;
+		unsigned int m_pending_count; // deferred unprotects, may drop to zero while keyed
+	public:
+		Entry() : m_js_value(NULL), m_js_ctx(NULL), m_pending_count(0) {}
+	};
+
+	std::vector<Entry> m_entry_array; // open addressing, linear probing
+	size_t m_used_count; // keyed slots
+	size_t m_pending_count; // deferred unprotects across all slots
+	Stats m_stats;
+
+private:
+	ProtectJournal() : m_entry_array(kInitialCapacity), m_used_count(0), m_pending_count(0) {}
+	~ProtectJournal() {}
+
+	Entry* Find(JSValueRef js_value, bool insert);
+	void Grow();
+
+public:
+	void Protect(JSContextRef js_ctx, JSValueRef js_value);
+	void Unprotect(JSContextRef js_ctx, JSValueRef js_value);
+	void Flush();
+
+	size_t GetPendingCount() const { return m_pending_count; }
+	const Stats& GetStats() const { return m_stats; }
+	void PrintStats(FILE* out) const;
+
+private:
+	static ProtectJournal* sm_instance;
+
+public:
+	static ProtectJournal* GetInstance();
+};
+
 JSValueRef ExportValue(Handle<Value> value);
 JSObjectRef ExportObject(Handle<Object> object);
 Handle<Value> ImportValue(JSContextRef js_ctx, JSValueRef js_value);
 Handle<Object> ImportObject(JSContextRef js_ctx, JSObjectRef js_object);
+Object* WrapObject(JSContextRef js_ctx, JSObjectRef js_object); // new wrapper for a pure-JS object
 
 } // namespace internal
 
@@ -368,6 +678,51 @@ public:
 	static Isolate* GetCurrent();
 };
 
+/// v8::HandleScope
+
+// Locals created while a HandleScope is active are counted once, in a
+// contiguous block of the shared handle stack, and released together when
+// the scope exits; the Locals themselves are plain borrowed pointers.
+// Without an active scope a Local owns its reference like a Handle.
+class V8EXPORT HandleScope
+{
+private:
+	HandleScope* m_previous_scope;
+	size_t m_handle_start; // first slot of this scope in sm_handle_array
+	bool m_is_closed;
+
+public:
+	HandleScope();
+	~HandleScope();
+
+	// releases this scope and re-creates the value in the enclosing one
+	template <class T> Local<T> Close(Handle<T> value)
+	{
+		_Leave(); // value still holds a reference of its own
+		return Local<T>(V8LIKE_MOVE(value));
+	}
+
+	static int NumberOfHandles();
+
+private:
+	void _Leave();
+
+	// Prevent copying and heap allocation of HandleScope objects.
+	HandleScope(const HandleScope&);
+	HandleScope& operator=(const HandleScope&);
+	static void* operator new(size_t size);
+	static void operator delete(void*, size_t);
+
+private:
+	static HandleScope* sm_current_scope;
+	static std::vector<internal::SmartObject*> sm_handle_array;
+
+public:
+	static bool _Adopt(internal::SmartObject* object); // true if the current scope took the reference
+	static bool _AdoptCounted(internal::SmartObject* object); // as _Adopt, for a reference already counted
+	static bool _IsActive() { return (sm_current_scope != NULL); }
+};
+
 /// v8::Handle<T>
 
 #define TYPE_CHECK(T, S) while (false) { *(static_cast<T* volatile*>(0)) = static_cast<S*>(0); }
@@ -378,6 +733,11 @@ public:
 	Handle(T* ptr = (T*) 0) : internal::SmartPointer<T>(ptr) {}
 	Handle(const Handle<T>& other) : internal::SmartPointer<T>(other) {}
 	template <class S> Handle(const Handle<S>& other) : internal::SmartPointer<T>(reinterpret_cast<T*>(other.GetPointer())) { TYPE_CHECK(T, S); }
+	#if __cplusplus >= 201103L
+	Handle(Handle<T>&& other) : internal::SmartPointer<T>(std::move(other)) {}
+	Handle& operator=(Handle<T>&& other) { internal::SmartPointer<T>::operator=(std::move(other)); return *this; }
+	#endif
+	Handle& operator=(const Handle<T>& other) { internal::SmartPointer<T>::operator=(other); return *this; }
 	virtual ~Handle() {}
 
 	// override dereference operator so SmartPointer behaves like a Handle
@@ -385,6 +745,9 @@ public:
 
 	template <class S> inline Handle<S> As() { return Handle<S>::Cast(*this); }
 
+protected:
+	Handle(T* ptr, bool is_borrowed) : internal::SmartPointer<T>(ptr, is_borrowed) {}
+
 public:
 	template <class S> static inline Handle<T> Cast(Handle<S> that) { return Handle<T>(T::Cast(*that)); }
 };
@@ -394,15 +757,28 @@ public:
 template <class T> class Local : public Handle<T>
 {
 public:
-	Local(T* ptr = (T*) 0) : Handle<T>(ptr) {}
-	Local(const Local<T>& other) : Handle<T>(other) {}
-	template <class S> Local(const Local<S>& other) : Handle<T>(reinterpret_cast<T*>(other.GetPointer())) { TYPE_CHECK(T, S); }
+	Local(T* ptr = (T*) 0) : Handle<T>(ptr, HandleScope::_Adopt(ptr)) {}
+	Local(const Local<T>& other) : Handle<T>(other.GetPointer(), other._IsBorrowed()) {}
+	template <class S> Local(const Local<S>& other) : Handle<T>(reinterpret_cast<T*>(other.GetPointer()), other._IsBorrowed()) { TYPE_CHECK(T, S); }
+	template <class S> Local(const Handle<S>& that) : Handle<T>(reinterpret_cast<T*>(that.GetPointer()), HandleScope::_Adopt(that.GetPointer())) { TYPE_CHECK(T, S); }
+	#if __cplusplus >= 201103L
+	Local(Local<T>&& other) { this->_Take(other, true); }
+	template <class S> Local(Handle<S>&& that)
+	{
+		TYPE_CHECK(T, S);
+		// hand the reference that already holds to the current scope
+		this->_Acquire(reinterpret_cast<T*>(that._Release()));
+		if (HandleScope::_AdoptCounted(this->GetPointer())) { this->_Lend(); }
+	}
+	Local& operator=(Local<T>&& other) { internal::SmartPointer<T>::operator=(std::move(other)); return *this; }
+	#endif
+	Local& operator=(const Local<T>& other) { internal::SmartPointer<T>::operator=(other); return *this; }
 	virtual ~Local() {}
 
 	template <class S> inline Local<S> As() { return Local<S>::Cast(*this); }
 
 public:
-	static Local<T> New(Handle<T> that) { return Local<T>(that); }
+	static Local<T> New(Handle<T> that) { return Local<T>(V8LIKE_MOVE(that)); }
 	template <class S> static inline Local<T> Cast(Local<S> that) { return Local<T>(T::Cast(*that)); }
 };
 
@@ -439,17 +815,6 @@ public:
 	template <class S> static inline Persistent<T> Cast(Persistent<S> that) { return Persistent<T>(T::Cast(*that)); }
 };
 
-/// v8::HandleScope
-
-class HandleScope
-{
-public:
-	HandleScope() {}
-	~HandleScope() {}
-
-	template <class T> Local<T> Close(Handle<T> value) { return Local<T>(value); }
-};
-
 /// v8::Data
 
 class V8EXPORT Data : public internal::SmartObject
@@ -458,6 +823,10 @@ class V8EXPORT Data : public internal::SmartObject
 public:
 	V8EXPORT Data() {}
 	virtual ~Data() {}
+public:
+	// wrappers are carved from internal::SlabAllocator size classes
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr, size_t size);
 };
 
 /// v8::Value
@@ -465,6 +834,33 @@ public:
 class V8EXPORT Value : public Data
 {
 	RTTI_DECLARE();
+public:
+	// primitive values known at creation, answered without asking JSC
+	enum ImmediateType
+	{
+		kImmediateNone = 0, // unknown or not a primitive
+		kImmediateUndefined,
+		kImmediateNull,
+		kImmediateBoolean,
+		kImmediateNumber
+	};
+
+	// what an object value is, classified once and kept on the wrapper
+	enum ObjectKind
+	{
+		kObjectKindUnknown = 0, // not classified yet
+		kObjectKindNone, // not an object
+		kObjectKindPlain,
+		kObjectKindArray,
+		kObjectKindFunction,
+		kObjectKindDate,
+		kObjectKindRegExp,
+		kObjectKindNativeError,
+		kObjectKindBooleanObject,
+		kObjectKindNumberObject,
+		kObjectKindStringObject
+	};
+
 public:
 	JSContextRef m_js_ctx;
 	JSValueRef m_js_value;
@@ -476,6 +872,10 @@ public:
 	bool m_is_independent;
 	uint16_t m_class_id;
 	bool m_is_near_death;
+	bool m_is_immortal;
+	ImmediateType m_immediate_type;
+	double m_immediate_value; // number, or 0/1 for booleans
+	ObjectKind m_object_kind;
 public:
 	V8EXPORT Value();
 	V8EXPORT Value(JSContextRef js_ctx, JSValueRef js_value);
@@ -494,14 +894,20 @@ public:
 	virtual bool _IsWeak() const;
 	virtual void _SetWrapperClassId(uint16_t class_id);
 	virtual uint16_t _WrapperClassId() const;
+	virtual void _Materialize() {} // create the JS value of a value built lazily
 
 public:
-	//JSValueRef GetJSValue() { return m_js_value; }
+	JSValueRef GetJSValue() const { if (m_js_value == NULL) { const_cast<Value*>(this)->_Materialize(); } return m_js_value; }
 	void AttachJSContextAndJSValue(JSContextRef js_ctx, JSValueRef js_value);
 	void DetachJSContextAndJSValue();
 	void IncJSRef();
 	void DecJSRef();
 	unsigned int GetJSRef() { return m_js_ref; }
+	void MakeImmortal();
+	bool IsImmortal() const { return m_is_immortal; }
+	void SetImmediate(ImmediateType type, double value = 0.0);
+	bool IsImmediate() const { return (m_immediate_type != kImmediateNone); }
+	ObjectKind GetObjectKind();
 
 public:
 	bool IsUndefined();
@@ -517,6 +923,7 @@ public:
 	bool IsArray();
 	bool IsFunction();
 	bool IsExternal();
+	bool IsDate();
 	bool IsRegExp();
 	bool IsNativeError();
 	bool IsBooleanObject();
@@ -689,24 +1096,50 @@ public:
 	};
 
 public:
+	// retains the JSStringRef and copies its characters into a null-terminated buffer on first
+	// access, as v8 callers expect; use String::View to read them in place without a copy
 	class V8EXPORT Value
 	{
 	private:
-		uint16_t* m_str;
+		JSStringRef m_js_string;
+		mutable uint16_t* m_buffer;
 		int m_length;
 	public:
 		Value(Handle<v8::Value> value);
 		~Value();
 	public:
-		uint16_t* operator*() { return m_str; }
-		const uint16_t* operator*() const { return m_str; }
+		uint16_t* operator*() { return _GetBuffer(); }
+		const uint16_t* operator*() const { return _GetBuffer(); }
 		int length() const { return m_length; }
+	private:
+		uint16_t* _GetBuffer() const;
 	private:
 		// Disallow copying and assigning.
 		Value(const Value&);
 		void operator=(const Value&);
 	};
 
+public:
+	// read-only UTF-16 view; never copies, not null-terminated
+	class V8EXPORT View
+	{
+	private:
+		JSStringRef m_js_string;
+		const uint16_t* m_str;
+		int m_length;
+	public:
+		View(Handle<v8::Value> value);
+		View(const View& other);
+		~View();
+	public:
+		const uint16_t* operator*() const { return m_str; }
+		uint16_t operator[](int index) const { assert((0 <= index) && (index < m_length)); return m_str[index]; }
+		int length() const { return m_length; }
+	private:
+		// Disallow assigning.
+		void operator=(const View&);
+	};
+
 	class V8EXPORT ExternalStringResourceBase
 	{
 	public:
@@ -719,6 +1152,7 @@ public:
 		ExternalStringResourceBase(const ExternalStringResourceBase&);
 		void operator=(const ExternalStringResourceBase&);
 		//friend class v8::internal::Heap;
+		friend class v8::String; // disposes the resource once JSC holds a copy
 	};
 
 	class V8EXPORT ExternalStringResource : public ExternalStringResourceBase
@@ -741,10 +1175,41 @@ public:
 		ExternalAsciiStringResource() {}
 	};
 
+public:
+	// strings are immutable, so the content and its lengths are fetched once and never invalidated
+	mutable JSStringRef m_js_string; // retained, NULL until first use
+	mutable int m_length; // UTF-16 code units, -1 until known
+	mutable int m_utf8_length; // UTF-8 bytes without terminator, -1 until known
+	mutable int m_is_ascii; // 1 or 0, -1 until known
+	bool m_is_symbol;
+	mutable uint32_t m_hash; // of the UTF-16 content, valid once m_is_hashed
+	mutable bool m_is_hashed;
+
+	// a Concat result stays a rope of its operands until its characters or JS value are needed
+	static const int kRopeMinLength = 13; // shorter results are copied at once
+	mutable Handle<String> m_rope_left;
+	mutable Handle<String> m_rope_right;
+	mutable int m_rope_depth; // 0 once flat; unbounded, nothing walks a rope recursively
+
 public:
 	V8EXPORT String(JSContextRef js_ctx, JSValueRef js_value);
+	V8EXPORT String(JSContextRef js_ctx, JSStringRef js_string);
+	V8EXPORT String(JSContextRef js_ctx, Handle<String> left, Handle<String> right);
 	V8EXPORT virtual ~String();
 
+public:
+	virtual void _Materialize();
+	void _Flatten() const;
+
+public:
+	JSStringRef _GetJSString() const;
+	int _GetLength() const;
+	int _GetUtf8Length() const;
+	bool _IsAscii() const;
+	bool IsSymbol() const { return m_is_symbol; }
+	uint32_t _GetHash() const;
+	bool _ContentEquals(const String* other) const;
+
 public:
 	V8EXPORT int Length();
 	V8EXPORT int Utf8Length();
@@ -906,6 +1371,18 @@ public:
 	}
 };
 
+// the getter or setter function of an accessor installed as a real JS property
+class AccessorFunction
+{
+public:
+	Handle<String> m_name;
+	Accessor m_accessor;
+	bool m_is_setter;
+public:
+	AccessorFunction(Handle<String> name, const Accessor& accessor, bool is_setter) :
+		m_name(name), m_accessor(accessor), m_is_setter(is_setter) {}
+};
+
 class TemplateProperty
 {
 public:
@@ -935,7 +1412,7 @@ public:
 	PropertyAttribute m_attrib;
 	Handle<AccessorSignature> m_signature;
 public:
-	TemplateAccessor() {}
+	TemplateAccessor() : m_getter(NULL), m_setter(NULL), m_settings(DEFAULT), m_attrib(None) {}
 	TemplateAccessor(AccessorGetter getter, AccessorSetter setter, Handle<Value> data, 
 					 AccessControl settings, PropertyAttribute attrib, 
 					 Handle<AccessorSignature> signature) :
@@ -958,17 +1435,219 @@ public:
 	}
 };
 
-struct StringCompare { bool operator()(const Handle<String>& key1, const Handle<String>& key2) const; };
+/// v8::internal::PropertyName
+
+// name passed down the interception path; borrows the JSStringRef of the JSC callback and
+// only makes a String wrapper when a user callback needs one
+class PropertyName
+{
+private:
+	JSContextRef m_js_ctx;
+	JSStringRef m_js_string; // borrowed, or owned by m_string
+	mutable uint32_t m_hash;
+	mutable bool m_is_hashed;
+	mutable Handle<String> m_string;
+public:
+	PropertyName(JSContextRef js_ctx, JSStringRef js_string);
+	PropertyName(Handle<String> string);
+public:
+	uint32_t _GetHash() const;
+	bool _ContentEquals(const String* other) const;
+	bool _AsArrayIndex(uint32_t* index) const;
+	Handle<String> GetString() const;
+private:
+	// Disallow copying and assigning.
+	PropertyName(const PropertyName&);
+	void operator=(const PropertyName&);
+};
+
+/// v8::internal::StringHashMap<T>
+
+// string-keyed map with the std::map subset the helpers use; iterates in insertion order,
+// which is the order V8 reports template properties and accessors in
+template <class T> class StringHashMap
+{
+public:
+	class Entry
+	{
+	public:
+		Handle<String> first; // empty once erased
+		T second;
+		uint32_t m_hash;
+	public:
+		Entry() : m_hash(0) {}
+		Entry(const Handle<String>& key, uint32_t hash) : first(key), second(), m_hash(hash) {}
+	};
+
+	class iterator
+	{
+	private:
+		std::vector<Entry>* m_entry_array;
+		size_t m_index;
+	public:
+		iterator(std::vector<Entry>* entry_array, size_t index) : m_entry_array(entry_array), m_index(index) { Skip(); }
+		Entry& operator*() const { return (*m_entry_array)[m_index]; }
+		Entry* operator->() const { return &(*m_entry_array)[m_index]; }
+		iterator& operator++() { ++m_index; Skip(); return *this; }
+		bool operator==(const iterator& other) const { return (m_index == other.m_index); }
+		bool operator!=(const iterator& other) const { return (m_index != other.m_index); }
+		size_t GetIndex() const { return m_index; }
+	private:
+		void Skip() { while ((m_index < m_entry_array->size()) && (*m_entry_array)[m_index].first.IsEmpty()) { ++m_index; } }
+	};
+
+private:
+	std::vector<Entry> m_entry_array; // insertion order
+	std::vector<int> m_slot_array; // entry index or -1, linear probing, power-of-two size
+	size_t m_count;
+
+private:
+	static uint32_t HashOf(const Handle<String>& key) { return key->_GetHash(); }
+	static uint32_t HashOf(const PropertyName& key) { return key._GetHash(); }
+	static bool Matches(const Entry& entry, uint32_t hash, const Handle<String>& key) { return (*entry.first == *key) || ((entry.m_hash == hash) && entry.first->_ContentEquals(*key)); }
+	static bool Matches(const Entry& entry, uint32_t hash, const PropertyName& key) { return (entry.m_hash == hash) && key._ContentEquals(*entry.first); }
+
+	template <class K> int FindSlot(const K& key, uint32_t hash) const
+	{
+		const size_t mask = m_slot_array.size() - 1;
+		for (size_t slot = hash & mask; m_slot_array[slot] >= 0; slot = (slot + 1) & mask)
+		{
+			if (Matches(m_entry_array[m_slot_array[slot]], hash, key))
+			{
+				return (int) slot;
+			}
+		}
+		return -1;
+	}
+	void Rebuild(size_t slot_count)
+	{
+		// drops erased entries and rehashes the rest, keeping their order
+		std::vector<Entry> entry_array;
+		entry_array.reserve(m_count);
+		for (size_t i = 0; i < m_entry_array.size(); ++i)
+		{
+			if (!m_entry_array[i].first.IsEmpty())
+			{
+				entry_array.push_back(m_entry_array[i]);
+			}
+		}
+		m_entry_array.swap(entry_array);
+		std::vector<int>(slot_count, -1).swap(m_slot_array);
+		const size_t mask = slot_count - 1;
+		for (size_t i = 0; i < m_entry_array.size(); ++i)
+		{
+			size_t slot = m_entry_array[i].m_hash & mask;
+			while (m_slot_array[slot] >= 0)
+			{
+				slot = (slot + 1) & mask;
+			}
+			m_slot_array[slot] = (int) i;
+		}
+	}
+
+public:
+	StringHashMap() : m_slot_array(8, -1), m_count(0) {}
+
+	size_t size() const { return m_count; }
+	bool empty() const { return (m_count == 0); }
+	iterator begin() { return iterator(&m_entry_array, 0); }
+	iterator end() { return iterator(&m_entry_array, m_entry_array.size()); }
+
+	void clear()
+	{
+		m_entry_array.clear();
+		std::vector<int>(8, -1).swap(m_slot_array);
+		m_count = 0;
+	}
+
+	template <class K> iterator find(const K& key)
+	{
+		const int slot = FindSlot(key, HashOf(key));
+		return (slot >= 0)?(iterator(&m_entry_array, m_slot_array[slot])):(end());
+	}
+
+	T& operator[](const Handle<String>& key)
+	{
+		const uint32_t hash = key->_GetHash();
+		const int slot = FindSlot(key, hash);
+		if (slot >= 0)
+		{
+			return m_entry_array[m_slot_array[slot]].second;
+		}
+		if (((m_entry_array.size() + 1) * 4) > (m_slot_array.size() * 3))
+		{
+			Rebuild((((m_count + 1) * 2) > m_slot_array.size())?(m_slot_array.size() * 2):(m_slot_array.size()));
+		}
+		const size_t mask = m_slot_array.size() - 1;
+		size_t free_slot = hash & mask;
+		while (m_slot_array[free_slot] >= 0)
+		{
+			free_slot = (free_slot + 1) & mask;
+		}
+		m_slot_array[free_slot] = (int) m_entry_array.size();
+		m_entry_array.push_back(Entry(key, hash));
+		++m_count;
+		return m_entry_array.back().second;
+	}
+
+	void erase(iterator it)
+	{
+		Entry& entry = *it;
+		const size_t mask = m_slot_array.size() - 1;
+		size_t slot = entry.m_hash & mask;
+		while (m_slot_array[slot] != (int) it.GetIndex())
+		{
+			slot = (slot + 1) & mask;
+		}
+		// shift later members of the probe run back so lookups never stop early
+		size_t next = (slot + 1) & mask;
+		while (m_slot_array[next] >= 0)
+		{
+			const size_t home = m_entry_array[m_slot_array[next]].m_hash & mask;
+			if (((next - home) & mask) >= ((next - slot) & mask))
+			{
+				m_slot_array[slot] = m_slot_array[next];
+				slot = next;
+			}
+			next = (next + 1) & mask;
+		}
+		m_slot_array[slot] = -1;
+		entry = Entry(); // the slot stays in m_entry_array until the next rebuild
+		--m_count;
+	}
+};
 
 #if 0 // V8LIKE_PROPERTY_MAP
-class PropertyMap : public std::map<Handle<String>, Property, StringCompare> {};
+class PropertyMap : public StringHashMap<Property> {};
 #endif
 
-class AccessorMap : public std::map<Handle<String>, Accessor, StringCompare> {};
+class AccessorMap : public StringHashMap<Accessor> {};
 
-class TemplatePropertyMap : public std::map<Handle<String>, TemplateProperty, StringCompare> {};
+class TemplatePropertyMap : public StringHashMap<TemplateProperty> {};
 
-class TemplateAccessorMap : public std::map<Handle<String>, TemplateAccessor, StringCompare> {};
+class TemplateAccessorMap : public StringHashMap<TemplateAccessor> {};
+
+// which handler of an ObjectTemplate chain answers a get for a name
+class TemplateLookup
+{
+public:
+	enum Kind
+	{
+		kKindNone,
+		kKindAccessor,
+		kKindNamedGetter,
+		kKindIndexedGetter
+	};
+public:
+	Kind m_kind;
+	ObjectTemplate* m_holder; // the template in the prototype chain that resolved the name
+	TemplateAccessor* m_accessor; // for kKindAccessor, in m_holder's accessor map
+	const Handle<String>* m_accessor_name; // its key there, passed to the getter instead of a new wrapper
+public:
+	TemplateLookup() : m_kind(kKindNone), m_holder(NULL), m_accessor(NULL), m_accessor_name(NULL) {}
+};
+
+class TemplateLookupCache : public StringHashMap<TemplateLookup> {};
 
 class Helper
 {
@@ -982,6 +1661,7 @@ private:
 public:
 	Handle<ObjectTemplate> m_object_template;	// for Objects created by ObjectTemplate::NewInstance
 	Handle<Function> m_function;				// for Objects created by Function::NewInstance
+	JSClassRef m_js_class;						// the template class the object was created with, if any
 
 	#if 0 // V8LIKE_PROPERTY_MAP
 	internal::PropertyMap m_property_map;
@@ -1005,11 +1685,100 @@ public:
 
 public:
 	void SetInternalFieldCount(int internal_field_count);
+	bool NeedsInterception() const;
 
 public:
 	static void WeakFree(Persistent<Value> object, void* parameter);
 };
 
+// per-context wrappers handed out instead of allocating a new one per call
+// global constructors fetched once per context
+#define V8LIKE_BUILTIN_LIST(V) \
+	V(Array) V(Boolean) V(Date) V(Error) V(Function) V(Number) V(Object) V(RegExp) V(String)
+
+class ContextCache
+{
+public:
+	enum Builtin
+	{
+		#define V8LIKE_BUILTIN_ENUM(name) kBuiltin##name,
+		V8LIKE_BUILTIN_LIST(V8LIKE_BUILTIN_ENUM)
+		#undef V8LIKE_BUILTIN_ENUM
+		kBuiltinCount
+	};
+
+public:
+	static const int kSmallIntegerMin = -128; // range of the small-integer cache
+	static const int kSmallIntegerMax = 1024;
+	static const int kSmallIntegerCount = kSmallIntegerMax - kSmallIntegerMin + 1;
+
+	class Stats
+	{
+	public:
+		size_t m_small_integer_hit_count; // served from the small-integer cache
+		size_t m_small_integer_miss_count; // out of range, fractional, -0, or first use
+		size_t m_object_hit_count; // pure-JS objects imported through an existing wrapper
+		size_t m_object_miss_count; // pure-JS objects that needed a new wrapper
+		size_t m_symbol_hit_count; // NewSymbol calls served from the intern table
+		size_t m_symbol_miss_count; // symbols created, or not internable
+	public:
+		Stats() : m_small_integer_hit_count(0), m_small_integer_miss_count(0), m_object_hit_count(0), m_object_miss_count(0), m_symbol_hit_count(0), m_symbol_miss_count(0) {}
+	};
+
+	class Symbol
+	{
+	public:
+		uint32_t m_hash;
+		String* m_string; // NULL for an empty slot, otherwise holds a reference
+	public:
+		Symbol() : m_hash(0), m_string(NULL) {}
+	};
+
+public:
+	JSContextRef m_js_ctx;
+	JSObjectRef m_js_global_object;
+
+	JSObjectRef m_js_builtin_array[kBuiltinCount]; // protected, fetched on first use
+	JSObjectRef m_js_object_to_string; // Object.prototype.toString, protected; NULL until fetched
+	JSObjectRef m_js_array_is_array; // Array.isArray, protected, fetched with the above
+	JSObjectRef m_js_date_get_time; // Date.prototype.getTime, protected, fetched with the above
+
+	Primitive* m_undefined_value;	// immortal
+	Primitive* m_null_value;		// immortal
+	Boolean* m_true_value;			// immortal
+	Boolean* m_false_value;			// immortal
+
+	Integer* m_small_integer_array[kSmallIntegerCount]; // immortal, built on first use
+
+	PointerMap<Object> m_object_map; // pure-JS JSObjectRef -> live wrapper, evicted by ~Object
+
+	std::vector<Symbol> m_symbol_array; // interned strings by content hash, linear probing, power-of-two size
+	size_t m_symbol_count;
+
+	Stats m_stats;
+
+public:
+	ContextCache(JSContextRef js_ctx);
+	virtual ~ContextCache();
+
+private:
+	void FetchJSBuiltins();
+	void GrowSymbols();
+
+public:
+	JSObjectRef GetJSBuiltin(JSContextRef js_ctx, Builtin builtin);
+	JSObjectRef GetJSObjectToString(JSContextRef js_ctx);
+	JSObjectRef GetJSArrayIsArray(JSContextRef js_ctx);
+	JSObjectRef GetJSDateGetTime(JSContextRef js_ctx);
+	Integer* GetSmallInteger(double value);
+	Object* FindObject(JSObjectRef js_object);
+	void AddObject(Object* object);
+	void RemoveObject(Object* object);
+	String* GetSymbol(const char* data, int length);
+	const Stats& GetStats() const { return m_stats; }
+	void PrintStats(FILE* out) const;
+};
+
 } // namespace internal
 
 /// v8::Object
@@ -1022,10 +1791,11 @@ public:
 	JSObjectRef m_js_object;
 	bool m_is_native;
 	internal::Helper* m_helper;
+	internal::ContextCache* m_identity_cache; // holds this pure-JS wrapper in its object map
 
 public:
 	Object();
-	Object(JSContextRef js_ctx);
+	Object(JSContextRef js_ctx, JSClassRef js_class = NULL);
 	Object(JSContextRef js_ctx, JSObjectRef js_object);
 	virtual ~Object();
 
@@ -1036,11 +1806,12 @@ public:
 	internal::Helper* GetHelper();
 
 public:
-	bool _ObjectHasProperty(Handle<String> name);
-	Handle<Value> _ObjectGetProperty(Handle<String> name);
-	bool _ObjectSetProperty(Handle<String> name, Handle<Value> value, PropertyAttribute attrib);
-	bool _ObjectDeleteProperty(Handle<String> name);
+	bool _ObjectHasProperty(const internal::PropertyName& name);
+	Handle<Value> _ObjectGetProperty(const internal::PropertyName& name);
+	bool _ObjectSetProperty(const internal::PropertyName& name, Handle<Value> value, PropertyAttribute attrib);
+	bool _ObjectDeleteProperty(const internal::PropertyName& name);
 	void _ObjectGetPropertyNames(JSPropertyNameAccumulatorRef js_name_accumulator);
+	bool _ObjectDefineAccessor(Handle<String> name, const internal::Accessor& accessor);
 
 public:
 	V8EXPORT bool Has(Handle<String> key);
@@ -1118,16 +1889,23 @@ public:
 
 public:
 	static JSClassRef sm_js_class;
+	static JSClassRef sm_js_accessor_class;
 
 public:
 	V8EXPORT static Local<Object> New();
 	V8EXPORT static Object* Cast(Value* value);
 public:
 	static JSClassRef GetJSClass();
+	static JSClassRef _CreateJSTemplateClass(JSStaticValue* js_static_values);
+	static JSClassRef _GetJSAccessorClass();
 
 private:
+	static void _JS_FinalizeAccessor(JSObjectRef js_function);
+	static JSValueRef _JS_CallAccessor(JSContextRef js_ctx, JSObjectRef js_function, JSObjectRef js_that, size_t js_argc, const JSValueRef js_argv[], JSValueRef* js_exception);
 	static void _JS_Initialize(JSContextRef js_ctx, JSObjectRef js_object);
 	static void _JS_Finalize(JSObjectRef js_object);
+	static JSValueRef _JS_GetStaticValue(JSContextRef js_ctx, JSObjectRef js_object, JSStringRef js_name, JSValueRef *js_exception);
+	static bool _JS_SetStaticValue(JSContextRef js_ctx, JSObjectRef js_object, JSStringRef js_name, JSValueRef js_value, JSValueRef *js_exception);
 	static bool _JS_HasProperty(JSContextRef js_ctx, JSObjectRef js_object, JSStringRef js_name);
 	static JSValueRef _JS_GetProperty(JSContextRef js_ctx, JSObjectRef js_object, JSStringRef js_name, JSValueRef *js_exception);
 	static bool _JS_SetProperty(JSContextRef js_ctx, JSObjectRef js_object, JSStringRef js_name, JSValueRef js_value, JSValueRef *js_exception);
@@ -1230,10 +2008,10 @@ public:
 	virtual ~Function() {}
 
 public:
-	bool _FunctionHasProperty(Handle<String> name);
-	Handle<Value> _FunctionGetProperty(Handle<String> name);
-	bool _FunctionSetProperty(Handle<String> name, Handle<Value> value, PropertyAttribute attrib);
-	bool _FunctionDeleteProperty(Handle<String> name);
+	bool _FunctionHasProperty(const internal::PropertyName& name);
+	Handle<Value> _FunctionGetProperty(const internal::PropertyName& name);
+	bool _FunctionSetProperty(const internal::PropertyName& name, Handle<Value> value, PropertyAttribute attrib);
+	bool _FunctionDeleteProperty(const internal::PropertyName& name);
 	void _FunctionGetPropertyNames(JSPropertyNameAccumulatorRef js_name_accumulator);
 
 public:
@@ -1316,7 +2094,7 @@ public:
 		kMultiline = 4
 	};
 public:
-	Local<String> m_source;
+	Handle<String> m_source;
 	Flags m_flags;
 public:
 	RegExp(JSContextRef js_ctx, Handle<String> pattern, Flags flags);
@@ -1325,7 +2103,7 @@ public:
 public:
 	V8EXPORT Local<String> GetSource() const
 	{
-		return m_source;
+		return Local<String>(m_source);
 	}
 	V8EXPORT Flags GetFlags() const
 	{
@@ -1579,15 +2357,34 @@ public:
 
 	bool m_undetectable;
 
+	// drawn from one counter on creation and on every change to the handlers or the prototype
+	// template, so the largest version along the chain moves only when a template in it changes
+	static uint32_t sm_version_counter;
+	uint32_t m_version;
+
+	// get resolutions by name, valid for the chain version they were made at
+	static const size_t kLookupCacheMaxSize = 256;
+	internal::TemplateLookupCache m_lookup_cache;
+	uint32_t m_lookup_version;
+
+	// class of the instances, with the accessors of the chain as static values; rebuilt when the
+	// chain version moves, NULL for templates with interceptors, which use Object::GetJSClass()
+	JSClassRef m_js_class;
+	uint32_t m_js_class_version;
+
 public:
 	ObjectTemplate();
 	virtual ~ObjectTemplate();
 
 public:
-	bool _ObjectTemplateHasProperty(Handle<Object> object, Handle<String> name);
-	Handle<Value> _ObjectTemplateGetProperty(Handle<Object> object, Handle<String> name);
-	bool _ObjectTemplateSetProperty(Handle<Object> object, Handle<String> name, Handle<Value> value);
-	bool _ObjectTemplateDeleteProperty(Handle<Object> object, Handle<String> name);
+	bool _ObjectTemplateHasProperty(Handle<Object> object, const internal::PropertyName& name);
+	Handle<Value> _ObjectTemplateGetProperty(Handle<Object> object, const internal::PropertyName& name);
+	internal::TemplateLookup _ObjectTemplateResolveGetter(const internal::PropertyName& name);
+	uint32_t _GetChainVersion() const;
+	JSClassRef _GetJSClass();
+	bool _IsCurrentJSClass(JSClassRef js_class) const { return (js_class != NULL) && (js_class == m_js_class) && (m_js_class_version == _GetChainVersion()); }
+	bool _ObjectTemplateSetProperty(Handle<Object> object, const internal::PropertyName& name, Handle<Value> value);
+	bool _ObjectTemplateDeleteProperty(Handle<Object> object, const internal::PropertyName& name);
 	void _ObjectTemplateGetPropertyNames(Handle<Object> object, JSPropertyNameAccumulatorRef js_name_accumulator);
 
 public:
@@ -1633,10 +2430,10 @@ public:
 	virtual ~FunctionTemplate();
 
 public:
-	bool _FunctionTemplateHasProperty(Handle<Function> function, Handle<String> name);
-	Handle<Value> _FunctionTemplateGetProperty(Handle<Function> function, Handle<String> name);
-	bool _FunctionTemplateSetProperty(Handle<Function> function, Handle<String> name, Handle<Value> value);
-	bool _FunctionTemplateDeleteProperty(Handle<Function> function, Handle<String> name);
+	bool _FunctionTemplateHasProperty(Handle<Function> function, const internal::PropertyName& name);
+	Handle<Value> _FunctionTemplateGetProperty(Handle<Function> function, const internal::PropertyName& name);
+	bool _FunctionTemplateSetProperty(Handle<Function> function, const internal::PropertyName& name, Handle<Value> value);
+	bool _FunctionTemplateDeleteProperty(Handle<Function> function, const internal::PropertyName& name);
 	void _FunctionTemplateGetPropertyNames(Handle<Function> function, JSPropertyNameAccumulatorRef js_name_accumulator);
 
 public:
@@ -1718,6 +2515,8 @@ public:
 	JSGlobalContextRef m_js_global_ctx;
 	std::vector<JSContextRef> m_js_ctx_stack;
 
+	internal::ContextCache* m_cache;
+
 public:
 	Context();
 	virtual ~Context();
@@ -1733,6 +2532,7 @@ public:
 	static JSGlobalContextRef sm_initial_js_global_ctx;
 	static std::map<JSContextRef, JSObjectRef> sm_js_global_object_map;
 	static Persistent<Context> sm_initial_context;
+	static internal::ContextCache* sm_initial_cache;
 private:
 	static Persistent<Context> sm_entered_context;
 	static Persistent<Context> sm_current_context;
@@ -1743,6 +2543,7 @@ public:
 	static JSGlobalContextRef GetCurrentJSGlobalContext();
 	static JSContextRef GetCurrentJSContext();
 	static JSObjectRef GetJSGlobalObject(JSContextRef js_ctx, JSObjectRef js_object = NULL);
+	static internal::ContextCache* GetCurrentCache();
 public:
 	static Local<Context> GetEntered();
 	static Local<Context> GetCurrent();
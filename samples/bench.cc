@@ -0,0 +1,289 @@
+// Copyright 2012 the V8 project authors. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of Google Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "v8.h" // #include <v8.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+/**
+ * Timed loops over the parts of the API layer that have been tuned, so a
+ * change can be measured against the build before it.  Each line reports
+ * the time per operation and the handle reference traffic per operation,
+ * counted by v8::internal::SmartObject::GetIncRefCount().
+ *
+ * bench_main runs every benchmark, or only those named on the command line.
+ */
+
+
+int bench_main(int argc, char* argv[]);
+
+
+namespace {
+
+double NowMilliseconds() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+
+// Prints the time and IncRef calls between construction and destruction.
+class BenchTimer {
+ public:
+  BenchTimer(const char* name, int ops)
+      : name_(name),
+        ops_(ops),
+        start_(NowMilliseconds()),
+        inc_ref_start_(v8::internal::SmartObject::GetIncRefCount()) {}
+  ~BenchTimer() {
+    double ms = NowMilliseconds() - start_;
+    size_t inc_refs =
+        v8::internal::SmartObject::GetIncRefCount() - inc_ref_start_;
+    printf("%-28s %9d ops %10.3f ms %10.1f ns/op %7.2f IncRef/op\n",
+           name_, ops_, ms, ms * 1e6 / ops_, (double) inc_refs / ops_);
+  }
+
+ private:
+  const char* name_;
+  int ops_;
+  double start_;
+  size_t inc_ref_start_;
+};
+
+
+v8::Handle<v8::Object> MakeObject(int i) {
+  v8::HandleScope handle_scope;
+  v8::Local<v8::Object> object = v8::Object::New();
+  object->Set(v8::Integer::New(0), v8::Integer::New(i));
+  return handle_scope.Close(object);
+}
+
+
+// Handle creation, HandleScope::Close and property access: the paths the
+// rvalue Handle/Local constructors were added for.
+void BenchHandles() {
+  const int kOps = 100000;
+  {
+    BenchTimer timer("handles/integer-new", kOps);
+    for (int i = 0; i < kOps; ++i) {
+      v8::HandleScope handle_scope;
+      v8::Local<v8::Integer> value = v8::Integer::New(i);
+      (void) value;
+    }
+  }
+  {
+    BenchTimer timer("handles/scope-close", kOps);
+    for (int i = 0; i < kOps; ++i) {
+      v8::HandleScope handle_scope;
+      MakeObject(i);
+    }
+  }
+  {
+    v8::HandleScope handle_scope;
+    v8::Local<v8::Object> object = v8::Object::New();
+    v8::Local<v8::String> key = v8::String::NewSymbol("key");
+    BenchTimer timer("handles/object-set-get", kOps);
+    for (int i = 0; i < kOps; ++i) {
+      v8::HandleScope inner_scope;
+      object->Set(key, v8::Integer::New(i));
+      object->Get(key);
+    }
+  }
+}
+
+
+// The loop String::New(const char*, int) used before the vector kernel: a
+// heap buffer filled one byte at a time, then handed to the two-byte New.
+v8::Local<v8::String> NewWithScalarLoop(const char* data, int length) {
+  uint16_t* buffer = new uint16_t[length];
+  for (int i = 0; i < length; ++i) {
+    buffer[i] = static_cast<unsigned char>(data[i]);
+  }
+  v8::Local<v8::String> result = v8::String::New(buffer, length);
+  delete[] buffer;
+  return result;
+}
+
+
+// String::New on ASCII input against the old scalar loop, at a key-sized,
+// a stack-buffer-sized and a heap-sized length, then on UTF-8 input whose
+// first non-ASCII byte ends the vector prefix.
+void BenchStrings() {
+  const int kLengths[] = { 16, 256, 65536 };
+  const int kTotalBytes = 16 << 20;
+  char* ascii = new char[65536];
+  char* utf8 = new char[65536];
+  for (int i = 0; i < 65536; ++i) {
+    ascii[i] = static_cast<char>('a' + i % 26);
+    utf8[i] = ascii[i];
+  }
+  for (int i = 1024; i + 1 < 65536; i += 64) {
+    utf8[i] = static_cast<char>(0xc3);  // U+00E9 every 64 bytes past 1 KB
+    utf8[i + 1] = static_cast<char>(0xa9);
+  }
+  for (size_t l = 0; l < sizeof(kLengths) / sizeof(*kLengths); ++l) {
+    const int length = kLengths[l];
+    const int ops = kTotalBytes / length;
+    char name[64];
+    snprintf(name, sizeof(name), "strings/widen-%d", length);
+    {
+      BenchTimer timer(name, ops);
+      for (int i = 0; i < ops; ++i) {
+        v8::HandleScope handle_scope;
+        v8::String::New(ascii, length);
+      }
+    }
+    snprintf(name, sizeof(name), "strings/scalar-loop-%d", length);
+    {
+      BenchTimer timer(name, ops);
+      for (int i = 0; i < ops; ++i) {
+        v8::HandleScope handle_scope;
+        NewWithScalarLoop(ascii, length);
+      }
+    }
+  }
+  {
+    const int ops = kTotalBytes / 65536;
+    BenchTimer timer("strings/utf8-65536", ops);
+    for (int i = 0; i < ops; ++i) {
+      v8::HandleScope handle_scope;
+      v8::String::New(utf8, 65536);
+    }
+  }
+  delete[] ascii;
+  delete[] utf8;
+}
+
+
+// Appending to a string in a loop, then reading it once, at growing
+// lengths: with Concat results kept as ropes the time per append should
+// stay flat as the count grows, instead of growing with the string.
+void BenchConcat() {
+  const int kCounts[] = { 1000, 10000, 100000 };
+  for (size_t c = 0; c < sizeof(kCounts) / sizeof(*kCounts); ++c) {
+    const int count = kCounts[c];
+    char name[64];
+    snprintf(name, sizeof(name), "strings/append-%d", count);
+    v8::HandleScope handle_scope;
+    v8::Local<v8::String> piece = v8::String::New("0123456789abcdef");
+    BenchTimer timer(name, count);
+    v8::Local<v8::String> result = v8::String::Empty();
+    for (int i = 0; i < count; ++i) {
+      result = v8::String::Concat(result, piece);
+    }
+    char last;
+    result->WriteAscii(&last, result->Length() - 1, 1,
+                       v8::String::NO_NULL_TERMINATION);
+  }
+}
+
+
+v8::Handle<v8::Value> GetIndex(v8::Local<v8::String> property,
+                               const v8::AccessorInfo& info) {
+  return info.Data();
+}
+
+
+// Reads through template accessors on objects with 10, 100 and 1000 of
+// them, cycling over every name, once with the interned names the
+// accessors were registered with and once with equal strings made afresh,
+// which have to be hashed and compared by content.
+void BenchAccessors() {
+  const int kCounts[] = { 10, 100, 1000 };
+  const int kOps = 100000;
+  for (size_t c = 0; c < sizeof(kCounts) / sizeof(*kCounts); ++c) {
+    const int count = kCounts[c];
+    v8::HandleScope handle_scope;
+    v8::Local<v8::ObjectTemplate> templ = v8::ObjectTemplate::New();
+    char key[32];
+    for (int i = 0; i < count; ++i) {
+      snprintf(key, sizeof(key), "accessor%d", i);
+      templ->SetAccessor(v8::String::NewSymbol(key), GetIndex, NULL,
+                         v8::Integer::New(i));
+    }
+    v8::Local<v8::Object> object = templ->NewInstance();
+    char name[64];
+    snprintf(name, sizeof(name), "accessors/symbol-%d", count);
+    {
+      BenchTimer timer(name, kOps);
+      for (int i = 0; i < kOps; ++i) {
+        v8::HandleScope inner_scope;
+        snprintf(key, sizeof(key), "accessor%d", i % count);
+        object->Get(v8::String::NewSymbol(key));
+      }
+    }
+    snprintf(name, sizeof(name), "accessors/string-%d", count);
+    {
+      BenchTimer timer(name, kOps);
+      for (int i = 0; i < kOps; ++i) {
+        v8::HandleScope inner_scope;
+        snprintf(key, sizeof(key), "accessor%d", i % count);
+        object->Get(v8::String::New(key));
+      }
+    }
+  }
+}
+
+
+struct Bench {
+  const char* name;
+  void (*function)();
+};
+
+const Bench kBenches[] = {
+  { "handles", BenchHandles },
+  { "strings", BenchStrings },
+  { "concat", BenchConcat },
+  { "accessors", BenchAccessors },
+};
+
+}  // namespace
+
+
+int bench_main(int argc, char* argv[]) {
+  v8::V8::SetFlagsFromCommandLine(&argc, argv, true);
+  {
+    v8::HandleScope handle_scope;
+    v8::Persistent<v8::Context> context = v8::Context::New();
+    if (context.IsEmpty()) {
+      printf("Error creating context\n");
+      return 1;
+    }
+    context->Enter();
+    for (size_t b = 0; b < sizeof(kBenches) / sizeof(*kBenches); ++b) {
+      bool run = (argc <= 1);
+      for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], kBenches[b].name) == 0) run = true;
+      }
+      if (run) kBenches[b].function();
+    }
+    context->Exit();
+    context.Dispose();
+  }
+  return 0;
+}
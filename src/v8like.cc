@@ -31,119 +31,444 @@
 #include <cmath>
 #include <limits>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define V8LIKE_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define V8LIKE_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+// 64-bit JSC encodes undefined, null, booleans and numbers in the JSValueRef
+// itself; JSVALUE32_64 builds box them in a collectable cell at the C API
+#if defined(__LP64__) || defined(_WIN64)
+#define V8LIKE_JSVALUE64 1
+#else
+#define V8LIKE_JSVALUE64 0
+#endif
+
+// -DV8LIKE_NATIVE_ACCESSORS=1 installs Object::SetAccessor accessors as real getter/setter
+// properties rather than answering them from the interception callbacks
+#ifndef V8LIKE_NATIVE_ACCESSORS
+#define V8LIKE_NATIVE_ACCESSORS 0
+#endif
+
 extern "C" void JSSynchronousGarbageCollectForDebugging(JSContextRef ctx);
 
-static int JSStringCompare(JSStringRef str1, JSStringRef str2)
+// fixed property names, created once by JSNamesCreate and never released
+#define V8LIKE_JS_NAME_LIST(V) \
+	V(Array) V(Boolean) V(Buffer) V(Date) V(Error) V(Function) V(Number) V(Object) V(RegExp) V(String) \
+	V(__helper__) V(captureStackTrace) V(configurable) V(defineProperty) V(enumerable) V(get) \
+	V(getOwnPropertyDescriptor) V(getTime) V(isArray) V(length) V(prototype) V(set) V(stack) V(toString) V(writable)
+
+#define V8LIKE_JS_NAME_DEFINE(name) static JSStringRef sg_js_name_##name = NULL;
+V8LIKE_JS_NAME_LIST(V8LIKE_JS_NAME_DEFINE)
+#undef V8LIKE_JS_NAME_DEFINE
+
+// Object.prototype.toString results that map to a Value::ObjectKind
+#define V8LIKE_JS_BRAND_LIST(V) \
+	V(Array, Array) V(Boolean, BooleanObject) V(Date, Date) V(Error, NativeError) \
+	V(Number, NumberObject) V(RegExp, RegExp) V(String, StringObject)
+
+#define V8LIKE_JS_BRAND_DEFINE(brand, kind) static JSStringRef sg_js_brand_##brand = NULL;
+V8LIKE_JS_BRAND_LIST(V8LIKE_JS_BRAND_DEFINE)
+#undef V8LIKE_JS_BRAND_DEFINE
+
+// called before the first JS context is created, rather than from static initialisers that
+// would call into JSC before main and in no particular order
+static void JSNamesCreate()
 {
-	const size_t n1 = JSStringGetLength(str1);
-	const size_t n2 = JSStringGetLength(str2);
-	if (n1 != n2)
+	static bool sg_js_names_created = false;
+	if (sg_js_names_created)
 	{
-		return ((n1 < n2) ? -1 : +1);
+		return;
 	}
-	else
+	sg_js_names_created = true;
+
+	#define V8LIKE_JS_NAME_CREATE(name) sg_js_name_##name = JSStringCreateWithUTF8CString(#name);
+	V8LIKE_JS_NAME_LIST(V8LIKE_JS_NAME_CREATE)
+	#undef V8LIKE_JS_NAME_CREATE
+
+	#define V8LIKE_JS_BRAND_CREATE(brand, kind) sg_js_brand_##brand = JSStringCreateWithUTF8CString("[object " #brand "]");
+	V8LIKE_JS_BRAND_LIST(V8LIKE_JS_BRAND_CREATE)
+	#undef V8LIKE_JS_BRAND_CREATE
+}
+
+// zero-extend Latin-1 bytes to UTF-16 code units, 16 at a time where the target allows
+static void JSCharWidenLatin1(JSChar* dst, const char* src, size_t length)
+{
+	size_t i = 0;
+	#if defined(V8LIKE_SIMD_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	for ( ; (i + 16) <= length; i += 16)
 	{
-		const JSChar* s1 = JSStringGetCharactersPtr(str1);
-		const JSChar* s2 = JSStringGetCharactersPtr(str2);
-		size_t n = n1; // n1 == n2
-		for ( ; n--; s1++, s2++)
-			if (*s1 != *s2)
-				return ((*s1 < *s2) ? -1 : +1);
-		return 0;
+		const __m128i bytes = _mm_loadu_si128((const __m128i*) (src + i));
+		_mm_storeu_si128((__m128i*) (dst + i), _mm_unpacklo_epi8(bytes, zero));
+		_mm_storeu_si128((__m128i*) (dst + i + 8), _mm_unpackhi_epi8(bytes, zero));
+	}
+	#elif defined(V8LIKE_SIMD_NEON)
+	for ( ; (i + 16) <= length; i += 16)
+	{
+		const uint8x16_t bytes = vld1q_u8((const uint8_t*) (src + i));
+		vst1q_u16((uint16_t*) (dst + i), vmovl_u8(vget_low_u8(bytes)));
+		vst1q_u16((uint16_t*) (dst + i + 8), vmovl_u8(vget_high_u8(bytes)));
+	}
+	#endif
+	for ( ; i < length; ++i)
+	{
+		dst[i] = (unsigned char) src[i];
 	}
 }
 
-static bool JSValueIsBooleanObject(JSContextRef ctx, JSValueRef value)
+static JSStringRef JSStringCreateWithLatin1(const char* data, size_t length)
 {
-	JSStringRef name = JSStringCreateWithUTF8CString("Boolean");
-	JSObjectRef ctor = JSValueToObject(ctx, JSObjectGetProperty(ctx, JSContextGetGlobalObject(ctx), name, NULL), NULL);
-	JSStringRelease(name);
+	// short strings (names, keys, numbers) widen on the stack
+	JSChar stack_buffer[256];
+	JSChar* buffer = (length <= (sizeof(stack_buffer) / sizeof(*stack_buffer)))?(stack_buffer):(new JSChar[length]);
+	JSCharWidenLatin1(buffer, data, length);
+	JSStringRef js_string = JSStringCreateWithCharacters(buffer, length);
+	assert(JSStringGetCharactersPtr(js_string) != buffer);
+	assert(JSStringGetLength(js_string) == length);
+	if (buffer != stack_buffer)
+	{
+		delete[] buffer;
+	}
+	return js_string;
+}
 
-	return JSValueIsInstanceOfConstructor(ctx, value, ctor, NULL);
+// length of the leading run of code units below 0x80, 8 at a time where the target allows
+static size_t JSCharCountAscii(const JSChar* src, size_t length)
+{
+	size_t i = 0;
+	#if defined(V8LIKE_SIMD_SSE2)
+	const __m128i mask = _mm_set1_epi16((short) 0xff80);
+	const __m128i zero = _mm_setzero_si128();
+	for ( ; (i + 8) <= length; i += 8)
+	{
+		const __m128i units = _mm_loadu_si128((const __m128i*) (src + i));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, mask), zero)) != 0xffff)
+		{
+			break;
+		}
+	}
+	#elif defined(V8LIKE_SIMD_NEON) && defined(__aarch64__)
+	for ( ; (i + 8) <= length; i += 8)
+	{
+		if (vmaxvq_u16(vld1q_u16((const uint16_t*) (src + i))) >= 0x80)
+		{
+			break;
+		}
+	}
+	#endif
+	while ((i < length) && (src[i] < 0x80))
+	{
+		++i;
+	}
+	return i;
 }
 
-static bool JSValueIsNumberObject(JSContextRef ctx, JSValueRef value)
+// keep the low byte of each code unit, which is the character itself for ASCII
+static void JSCharNarrow(char* dst, const JSChar* src, size_t length)
 {
-	JSStringRef name = JSStringCreateWithUTF8CString("Number");
-	JSObjectRef ctor = JSValueToObject(ctx, JSObjectGetProperty(ctx, JSContextGetGlobalObject(ctx), name, NULL), NULL);
-	JSStringRelease(name);
+	size_t i = 0;
+	#if defined(V8LIKE_SIMD_SSE2)
+	const __m128i low_byte = _mm_set1_epi16(0x00ff);
+	for ( ; (i + 16) <= length; i += 16)
+	{
+		const __m128i lo = _mm_and_si128(_mm_loadu_si128((const __m128i*) (src + i)), low_byte);
+		const __m128i hi = _mm_and_si128(_mm_loadu_si128((const __m128i*) (src + i + 8)), low_byte);
+		_mm_storeu_si128((__m128i*) (dst + i), _mm_packus_epi16(lo, hi));
+	}
+	#elif defined(V8LIKE_SIMD_NEON)
+	for ( ; (i + 8) <= length; i += 8)
+	{
+		vst1_u8((uint8_t*) (dst + i), vmovn_u16(vld1q_u16((const uint16_t*) (src + i))));
+	}
+	#endif
+	for ( ; i < length; ++i)
+	{
+		dst[i] = (char) src[i];
+	}
+}
 
-	return JSValueIsInstanceOfConstructor(ctx, value, ctor, NULL);
+// exact UTF-8 size, without terminator; a lone surrogate takes 3 bytes either as itself or as U+FFFD
+static size_t JSCharUtf8Length(const JSChar* src, size_t length)
+{
+	size_t size = 0;
+	size_t i = 0;
+	while (i < length)
+	{
+		const size_t run = JSCharCountAscii(src + i, length - i);
+		size += run; i += run;
+		if (i == length)
+		{
+			break;
+		}
+		const JSChar c = src[i];
+		if (c < 0x800)
+		{
+			size += 2; i += 1;
+		}
+		else if ((0xd800 <= c) && (c <= 0xdbff) && ((i + 1) < length) && (0xdc00 <= src[i + 1]) && (src[i + 1] <= 0xdfff))
+		{
+			size += 4; i += 2;
+		}
+		else
+		{
+			size += 3; i += 1;
+		}
+	}
+	return size;
 }
 
-static bool JSValueIsStringObject(JSContextRef ctx, JSValueRef value)
+// encode as many whole characters as fit in capacity bytes; never splits a sequence
+// or a surrogate pair, writes no terminator, reports code units consumed in nchars_out
+static size_t JSCharEncodeUtf8(char* dst, size_t capacity, const JSChar* src, size_t length, size_t* nchars_out, bool replace_invalid)
 {
-	JSStringRef name = JSStringCreateWithUTF8CString("String");
-	JSObjectRef ctor = JSValueToObject(ctx, JSObjectGetProperty(ctx, JSContextGetGlobalObject(ctx), name, NULL), NULL);
-	JSStringRelease(name);
+	size_t pos = 0;
+	size_t i = 0;
+	while (i < length)
+	{
+		const size_t limit = ((length - i) < (capacity - pos))?(length - i):(capacity - pos);
+		const size_t run = JSCharCountAscii(src + i, limit);
+		JSCharNarrow(dst + pos, src + i, run);
+		pos += run; i += run;
+		if ((i == length) || (pos == capacity))
+		{
+			break;
+		}
 
-	return JSValueIsInstanceOfConstructor(ctx, value, ctor, NULL);
+		uint32_t c = src[i];
+		size_t units = 1;
+		if ((0xd800 <= c) && (c <= 0xdbff) && ((i + 1) < length) && (0xdc00 <= src[i + 1]) && (src[i + 1] <= 0xdfff))
+		{
+			c = 0x10000 + ((c - 0xd800) << 10) + (src[i + 1] - 0xdc00);
+			units = 2;
+		}
+		else if ((0xd800 <= c) && (c <= 0xdfff) && replace_invalid)
+		{
+			c = 0xfffd;
+		}
+
+		const size_t bytes = (c < 0x800)?(2):((c < 0x10000)?(3):(4));
+		if ((capacity - pos) < bytes)
+		{
+			break;
+		}
+		switch (bytes)
+		{
+		case 2:
+			dst[pos++] = (char) (0xc0 | (c >> 6));
+			break;
+		case 3:
+			dst[pos++] = (char) (0xe0 | (c >> 12));
+			dst[pos++] = (char) (0x80 | ((c >> 6) & 0x3f));
+			break;
+		default:
+			dst[pos++] = (char) (0xf0 | (c >> 18));
+			dst[pos++] = (char) (0x80 | ((c >> 12) & 0x3f));
+			dst[pos++] = (char) (0x80 | ((c >> 6) & 0x3f));
+			break;
+		}
+		dst[pos++] = (char) (0x80 | (c & 0x3f));
+		i += units;
+	}
+	if (nchars_out != NULL)
+	{
+		*nchars_out = i;
+	}
+	return pos;
 }
 
-static bool JSValueIsFunction(JSContextRef ctx, JSValueRef value)
+// decode UTF-8 into at most length code units; a malformed, overlong or surrogate
+// sequence becomes one U+FFFD per byte consumed by it, as V8 3.14 reads it
+static size_t JSCharDecodeUtf8(JSChar* dst, const char* src, size_t length)
 {
-	//JSStringRef name = JSStringCreateWithUTF8CString("Function");
-	//JSObjectRef ctor = JSValueToObject(ctx, JSObjectGetProperty(ctx, JSContextGetGlobalObject(ctx), name, NULL), NULL);
-	//JSStringRelease(name);
+	size_t pos = 0;
+	size_t i = 0;
+	while (i < length)
+	{
+		const unsigned char lead = (unsigned char) src[i];
+		if (lead < 0x80)
+		{
+			dst[pos++] = lead; i += 1;
+			continue;
+		}
 
-	//return JSValueIsInstanceOfConstructor(ctx, value, ctor, NULL);
+		size_t trail = 0;
+		uint32_t c = 0;
+		uint32_t min = 0;
+		if ((lead & 0xe0) == 0xc0) { trail = 1; c = lead & 0x1f; min = 0x80; }
+		else if ((lead & 0xf0) == 0xe0) { trail = 2; c = lead & 0x0f; min = 0x800; }
+		else if ((lead & 0xf8) == 0xf0) { trail = 3; c = lead & 0x07; min = 0x10000; }
 
-	if (JSValueIsObject(ctx, value))
+		size_t n = 1;
+		for ( ; (n <= trail) && ((i + n) < length) && ((src[i + n] & 0xc0) == 0x80); ++n)
+		{
+			c = (c << 6) | (src[i + n] & 0x3f);
+		}
+
+		if ((trail == 0) || (n <= trail) || (c < min) || (c > 0x10ffff) || ((0xd800 <= c) && (c <= 0xdfff)))
+		{
+			dst[pos++] = 0xfffd; i += 1;
+		}
+		else if (c >= 0x10000)
+		{
+			dst[pos++] = (JSChar) (0xd800 + ((c - 0x10000) >> 10));
+			dst[pos++] = (JSChar) (0xdc00 + ((c - 0x10000) & 0x3ff));
+			i += n;
+		}
+		else
+		{
+			dst[pos++] = (JSChar) c; i += n;
+		}
+	}
+	return pos;
+}
+
+static JSStringRef JSStringCreateWithUtf8(const char* data, size_t length)
+{
+	// the ASCII prefix goes through the widening kernel; from the first byte
+	// >= 0x80 the rest is decoded over it, never needing more units than bytes
+	JSChar stack_buffer[256];
+	JSChar* buffer = (length <= (sizeof(stack_buffer) / sizeof(*stack_buffer)))?(stack_buffer):(new JSChar[length]);
+	JSCharWidenLatin1(buffer, data, length);
+	size_t units = JSCharCountAscii(buffer, length);
+	if (units < length)
 	{
-		JSObjectRef object = JSValueToObject(ctx, value, NULL);
-		return JSObjectIsFunction(ctx, object);
+		units += JSCharDecodeUtf8(buffer + units, data + units, length - units);
 	}
-	return false;
+	JSStringRef js_string = JSStringCreateWithCharacters(buffer, units);
+	assert(JSStringGetCharactersPtr(js_string) != buffer);
+	if (buffer != stack_buffer)
+	{
+		delete[] buffer;
+	}
+	return js_string;
 }
 
-static bool JSValueIsArray(JSContextRef ctx, JSValueRef value)
+// FNV-1a over the code units
+static uint32_t JSCharHash(const JSChar* src, size_t length)
 {
-	JSStringRef name = JSStringCreateWithUTF8CString("Array");
-	JSObjectRef ctor = JSValueToObject(ctx, JSObjectGetProperty(ctx, JSContextGetGlobalObject(ctx), name, NULL), NULL);
-	JSStringRelease(name);
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < length; ++i)
+	{
+		hash = (hash ^ src[i]) * 16777619u;
+	}
+	return hash;
+}
 
-	//return JSValueIsInstanceOfConstructor(ctx, value, ctor, NULL);
+// canonical array index: decimal digits without leading zeros, below 2^32 - 1
+static bool JSCharParseArrayIndex(const JSChar* src, size_t length, uint32_t* index)
+{
+	if ((length == 0) || (length > 10) || (src[0] < '0') || (src[0] > '9') || ((src[0] == '0') && (length > 1)))
+	{
+		return false; // rejects every named key on its first character
+	}
+	uint64_t value = 0;
+	for (size_t i = 0; i < length; ++i)
+	{
+		const JSChar c = src[i];
+		if ((c < '0') || (c > '9'))
+		{
+			return false;
+		}
+		value = (value * 10) + (c - '0');
+	}
+	if (value >= 0xffffffffu)
+	{
+		return false;
+	}
+	*index = (uint32_t) value;
+	return true;
+}
 
-	name = JSStringCreateWithUTF8CString("isArray");
-	JSObjectRef func = JSValueToObject(ctx, JSObjectGetProperty(ctx, ctor, name, NULL), NULL);
-	JSStringRelease(name);
+static v8::Value::ObjectKind JSObjectClassify(JSContextRef ctx, JSObjectRef object)
+{
+	// callables are known without running script; anything else costs one call
+	// to Object.prototype.toString to read its class brand, plus a confirming
+	// call for the brands that Symbol.toStringTag or a class name can spoof
+	if (JSObjectIsFunction(ctx, object))
+	{
+		return v8::Value::kObjectKindFunction;
+	}
 
-	JSValueRef retval = JSObjectCallAsFunction(ctx, func, NULL, 1, &value, NULL);
+	v8::internal::ContextCache* cache = v8::Context::GetCurrentCache();
+	JSValueRef js_exception = NULL;
+	JSValueRef retval = JSObjectCallAsFunction(ctx, cache->GetJSObjectToString(ctx), object, 0, NULL, &js_exception);
 
-	if (JSValueIsBoolean(ctx, retval))
+	if ((js_exception != NULL) || !JSValueIsString(ctx, retval))
 	{
-		return JSValueToBoolean(ctx, retval);
+		return v8::Value::kObjectKindPlain;
 	}
 
-	return false;
+	v8::Value::ObjectKind kind = v8::Value::kObjectKindPlain;
+	JSStringRef brand = JSValueToStringCopy(ctx, retval, NULL);
+	#define V8LIKE_JS_BRAND_MATCH(name, name_kind) \
+		if (JSStringIsEqual(brand, sg_js_brand_##name)) { kind = v8::Value::kObjectKind##name_kind; } else
+	V8LIKE_JS_BRAND_LIST(V8LIKE_JS_BRAND_MATCH) {}
+	#undef V8LIKE_JS_BRAND_MATCH
+	JSStringRelease(brand);
+
+	if (kind == v8::Value::kObjectKindArray)
+	{
+		JSValueRef argv[] = { object };
+		retval = JSObjectCallAsFunction(ctx, cache->GetJSArrayIsArray(ctx), NULL, 1, argv, &js_exception);
+		if ((js_exception != NULL) || !JSValueToBoolean(ctx, retval))
+		{
+			kind = v8::Value::kObjectKindPlain;
+		}
+	}
+	else if (kind == v8::Value::kObjectKindDate)
+	{
+		// Date.prototype.getTime throws on anything without a time value
+		JSObjectCallAsFunction(ctx, cache->GetJSDateGetTime(ctx), object, 0, NULL, &js_exception);
+		if (js_exception != NULL)
+		{
+			kind = v8::Value::kObjectKindPlain;
+		}
+	}
+	return kind;
 }
 
-static bool JSValueIsDate(JSContextRef ctx, JSValueRef value)
+#ifndef NDEBUG // only used by asserts
+static bool JSValueIsObjectOfKind(JSContextRef ctx, JSValueRef value, v8::Value::ObjectKind kind)
 {
-	JSStringRef name = JSStringCreateWithUTF8CString("Date");
-	JSObjectRef ctor = JSValueToObject(ctx, JSObjectGetProperty(ctx, JSContextGetGlobalObject(ctx), name, NULL), NULL);
-	JSStringRelease(name);
-
-	return JSValueIsInstanceOfConstructor(ctx, value, ctor, NULL);
+	if (JSValueIsObject(ctx, value))
+	{
+		JSObjectRef object = JSValueToObject(ctx, value, NULL);
+		return (JSObjectClassify(ctx, object) == kind);
+	}
+	return false;
 }
+#endif
 
-static bool JSValueIsRegExp(JSContextRef ctx, JSValueRef value)
+static bool JSValueIsFunction(JSContextRef ctx, JSValueRef value)
 {
-	JSStringRef name = JSStringCreateWithUTF8CString("RegExp");
-	JSObjectRef ctor = JSValueToObject(ctx, JSObjectGetProperty(ctx, JSContextGetGlobalObject(ctx), name, NULL), NULL);
-	JSStringRelease(name);
+	if (JSValueIsObject(ctx, value))
+	{
+		JSObjectRef object = JSValueToObject(ctx, value, NULL);
+		return JSObjectIsFunction(ctx, object);
+	}
+	return false;
+}
 
-	return JSValueIsInstanceOfConstructor(ctx, value, ctor, NULL);
+#ifndef NDEBUG // only used by asserts
+static bool JSValueIsArray(JSContextRef ctx, JSValueRef value)
+{
+	return JSValueIsObjectOfKind(ctx, value, v8::Value::kObjectKindArray);
 }
 
-static bool JSValueIsError(JSContextRef ctx, JSValueRef value)
+static bool JSValueIsDate(JSContextRef ctx, JSValueRef value)
 {
-	JSStringRef name = JSStringCreateWithUTF8CString("Error");
-	JSObjectRef ctor = JSValueToObject(ctx, JSObjectGetProperty(ctx, JSContextGetGlobalObject(ctx), name, NULL), NULL);
-	JSStringRelease(name);
+	return JSValueIsObjectOfKind(ctx, value, v8::Value::kObjectKindDate);
+}
 
-	return JSValueIsInstanceOfConstructor(ctx, value, ctor, NULL);
+static bool JSValueIsRegExp(JSContextRef ctx, JSValueRef value)
+{
+	return JSValueIsObjectOfKind(ctx, value, v8::Value::kObjectKindRegExp);
 }
+#endif
 
 #if 1 // V8LIKE_DEBUG
 static bool sg_debug_print_script_stack_enable = false;
@@ -155,8 +480,7 @@ static void JSDebugPrintScriptStack(JSContextRef js_ctx)
 		JSValueRef js_exception = NULL;
 		JSValueToObject(js_ctx, JSValueMakeUndefined(js_ctx), &js_exception);
 		JSObjectRef js_error = JSValueToObject(js_ctx, js_exception, NULL);
-		JSStringRef js_name = JSStringCreateWithUTF8CString("stack");
-		JSValueRef js_stack = JSObjectGetProperty(js_ctx, js_error, js_name, NULL);
+		JSValueRef js_stack = JSObjectGetProperty(js_ctx, js_error, sg_js_name_stack, NULL);
 		JSStringRef js_string = JSValueToStringCopy(js_ctx, js_stack, NULL);
 		size_t js_size = JSStringGetMaximumUTF8CStringSize(js_string);
 		char* js_buffer = new char[js_size];
@@ -164,7 +488,6 @@ static void JSDebugPrintScriptStack(JSContextRef js_ctx)
 		printf("%s\n", js_buffer);
 		delete[] js_buffer; js_buffer = NULL;
 		JSStringRelease(js_string); js_string = NULL;
-		JSStringRelease(js_name); js_name = NULL;
 	}
 }
 #endif
@@ -175,8 +498,11 @@ static Handle<Value> sg_last_exception;
 
 /// v8::internal::SmartObject
 
+/*static*/ size_t internal::SmartObject::sm_inc_ref_count = 0;
+
 void internal::SmartObject::IncRef()
 {
+	++sm_inc_ref_count;
 	if (!_IsNearDeath())
 	{
 		if (m_ref++ == 0)
@@ -199,11 +525,300 @@ void internal::SmartObject::DecRef()
 	}
 }
 
+/// v8::internal::SlabAllocator
+
+#ifdef DEBUG // V8LIKE_SLAB_POISON
+static const unsigned char sg_slab_poison_free = 0xdb; // dead block
+static const unsigned char sg_slab_poison_alloc = 0xcb; // clean block
+#endif
+
+/*static*/ internal::SlabAllocator* internal::SlabAllocator::sm_instance = NULL;
+
+/*static*/ internal::SlabAllocator* internal::SlabAllocator::GetInstance()
+{
+	// v8::Isolate has no heap of its own and wrappers freely cross isolates,
+	// so there is one allocator per process; never deleted, so wrappers held
+	// by static handles can still be released during exit
+	if (sm_instance == NULL)
+	{
+		sm_instance = new internal::SlabAllocator();
+	}
+	return sm_instance;
+}
+
+void* internal::SlabAllocator::Allocate(size_t size)
+{
+	if ((size == 0) || (size > kMaxSize))
+	{
+		++m_large_stats.m_alloc_count;
+		++m_large_stats.m_live_count;
+		return ::operator new(size);
+	}
+
+	const size_t size_class = (size - 1) / kGranularity;
+	const size_t block_size = (size_class + 1) * kGranularity;
+	SizeClass& sc = m_size_class_array[size_class];
+
+	Block* block = sc.m_free_list;
+	if (block != NULL)
+	{
+		sc.m_free_list = block->m_next;
+		++sc.m_stats.m_reuse_count;
+		#ifdef DEBUG // V8LIKE_SLAB_POISON
+		// anything but the freelist link written since the free is a use-after-free
+		const unsigned char* bytes = (const unsigned char*) block;
+		for (size_t i = sizeof(Block); i < block_size; ++i)
+		{
+			assert(bytes[i] == sg_slab_poison_free);
+		}
+		#endif
+	}
+	else
+	{
+		if ((sc.m_slab_cursor == NULL) || ((size_t) (sc.m_slab_limit - sc.m_slab_cursor) < block_size))
+		{
+			// the tail of the previous slab (< block_size) is abandoned
+			char* slab = (char*) ::operator new(kSlabSize);
+			m_slab_array.push_back(slab);
+			sc.m_slab_cursor = slab;
+			sc.m_slab_limit = slab + kSlabSize;
+			++sc.m_stats.m_slab_count;
+		}
+		block = (Block*) sc.m_slab_cursor;
+		sc.m_slab_cursor += block_size;
+	}
+
+	#ifdef DEBUG // V8LIKE_SLAB_POISON
+	memset(block, sg_slab_poison_alloc, block_size);
+	#endif
+
+	++sc.m_stats.m_alloc_count;
+	++sc.m_stats.m_live_count;
+	return block;
+}
+
+void internal::SlabAllocator::Free(void* ptr, size_t size)
+{
+	if (ptr == NULL)
+	{
+		return;
+	}
+
+	if ((size == 0) || (size > kMaxSize))
+	{
+		assert(m_large_stats.m_live_count > 0); // check for underflow
+		++m_large_stats.m_free_count;
+		--m_large_stats.m_live_count;
+		::operator delete(ptr);
+		return;
+	}
+
+	const size_t size_class = (size - 1) / kGranularity;
+	SizeClass& sc = m_size_class_array[size_class];
+
+	#ifdef DEBUG // V8LIKE_SLAB_POISON
+	const size_t block_size = (size_class + 1) * kGranularity;
+	memset(ptr, sg_slab_poison_free, block_size);
+	#endif
+
+	Block* block = (Block*) ptr;
+	block->m_next = sc.m_free_list;
+	sc.m_free_list = block;
+
+	assert(sc.m_stats.m_live_count > 0); // check for underflow
+	++sc.m_stats.m_free_count;
+	--sc.m_stats.m_live_count;
+}
+
+size_t internal::SlabAllocator::GetUsedBytes() const
+{
+	size_t bytes = 0;
+	for (size_t size_class = 0; size_class < kSizeClassCount; ++size_class)
+	{
+		bytes += m_size_class_array[size_class].m_stats.m_live_count * (size_class + 1) * kGranularity;
+	}
+	return bytes;
+}
+
+void internal::SlabAllocator::PrintStats(FILE* out) const
+{
+	fprintf(out, "slab allocator: %lu slabs, %lu bytes reserved, %lu bytes used\n", (unsigned long) m_slab_array.size(), (unsigned long) GetReservedBytes(), (unsigned long) GetUsedBytes());
+	for (size_t size_class = 0; size_class < kSizeClassCount; ++size_class)
+	{
+		const Stats& stats = m_size_class_array[size_class].m_stats;
+		if (stats.m_alloc_count > 0)
+		{
+			fprintf(out, "  %3lu bytes: %lu allocs, %lu frees, %lu reused (%.1f%%), %lu live, %lu slabs\n",
+				(unsigned long) ((size_class + 1) * kGranularity),
+				(unsigned long) stats.m_alloc_count, (unsigned long) stats.m_free_count,
+				(unsigned long) stats.m_reuse_count, 100.0 * stats.m_reuse_count / stats.m_alloc_count,
+				(unsigned long) stats.m_live_count, (unsigned long) stats.m_slab_count);
+		}
+	}
+	if (m_large_stats.m_alloc_count > 0)
+	{
+		fprintf(out, "  large: %lu allocs, %lu frees, %lu live\n",
+			(unsigned long) m_large_stats.m_alloc_count, (unsigned long) m_large_stats.m_free_count,
+			(unsigned long) m_large_stats.m_live_count);
+	}
+}
+
+/// v8::internal::ProtectJournal
+
+/*static*/ internal::ProtectJournal* internal::ProtectJournal::sm_instance = NULL;
+
+/*static*/ internal::ProtectJournal* internal::ProtectJournal::GetInstance()
+{
+	// JSC keeps one protect count per value across the context group
+	if (sm_instance == NULL)
+	{
+		sm_instance = new internal::ProtectJournal();
+	}
+	return sm_instance;
+}
+
+internal::ProtectJournal::Entry* internal::ProtectJournal::Find(JSValueRef js_value, bool insert)
+{
+	const size_t mask = m_entry_array.size() - 1;
+	size_t index = ((((uintptr_t) js_value) >> 3) * 2654435761u) & mask;
+	while (true)
+	{
+		Entry& entry = m_entry_array[index];
+		if (entry.m_js_value == js_value)
+		{
+			return &entry;
+		}
+		if (entry.m_js_value == NULL)
+		{
+			if (!insert)
+			{
+				return NULL;
+			}
+			entry.m_js_value = js_value;
+			++m_used_count;
+			return &entry;
+		}
+		index = (index + 1) & mask;
+	}
+}
+
+void internal::ProtectJournal::Grow()
+{
+	// slots whose pending count dropped to zero are not carried over
+	std::vector<Entry> entry_array(m_entry_array.size() * 2);
+	entry_array.swap(m_entry_array);
+	m_used_count = 0;
+	for (size_t i = 0; i < entry_array.size(); ++i)
+	{
+		const Entry& entry = entry_array[i];
+		if (entry.m_pending_count > 0)
+		{
+			Entry* new_entry = Find(entry.m_js_value, true);
+			new_entry->m_js_ctx = entry.m_js_ctx;
+			new_entry->m_pending_count = entry.m_pending_count;
+		}
+	}
+}
+
+void internal::ProtectJournal::Protect(JSContextRef js_ctx, JSValueRef js_value)
+{
+	if (js_value == NULL)
+	{
+		return; // detached from a finalized JSObjectRef
+	}
+
+	Entry* entry = (m_pending_count > 0)?(Find(js_value, false)):(NULL);
+	if ((entry != NULL) && (entry->m_pending_count > 0))
+	{
+		// still protected in JSC; take back one of the journaled unprotects
+		--entry->m_pending_count;
+		--m_pending_count;
+		++m_stats.m_cancel_count;
+		return;
+	}
+
+	++m_stats.m_protect_count;
+	JSValueProtect(js_ctx, js_value);
+}
+
+void internal::ProtectJournal::Unprotect(JSContextRef js_ctx, JSValueRef js_value)
+{
+	if (js_value == NULL)
+	{
+		return; // detached from a finalized JSObjectRef
+	}
+
+	if (!HandleScope::_IsActive())
+	{
+		// nothing would flush a deferral made outside of a scope
+		++m_stats.m_unprotect_count;
+		JSValueUnprotect(js_ctx, js_value);
+		return;
+	}
+
+	if ((m_used_count + 1) * 4 > m_entry_array.size() * 3)
+	{
+		Grow();
+	}
+
+	Entry* entry = Find(js_value, true);
+	entry->m_js_ctx = js_ctx;
+	++entry->m_pending_count;
+	++m_pending_count;
+	++m_stats.m_defer_count;
+}
+
+void internal::ProtectJournal::Flush()
+{
+	if (m_used_count == 0)
+	{
+		return;
+	}
+
+	if (m_pending_count > 0)
+	{
+		++m_stats.m_flush_count;
+	}
+
+	for (size_t i = 0; i < m_entry_array.size(); ++i)
+	{
+		Entry& entry = m_entry_array[i];
+		for (unsigned int count = entry.m_pending_count; count > 0; --count)
+		{
+			++m_stats.m_unprotect_count;
+			JSValueUnprotect(entry.m_js_ctx, entry.m_js_value);
+		}
+		entry = Entry();
+	}
+	m_used_count = 0;
+	m_pending_count = 0;
+
+	if (m_entry_array.size() > (kInitialCapacity * 16))
+	{
+		// give back the table a burst of deferrals grew
+		std::vector<Entry>(kInitialCapacity).swap(m_entry_array);
+	}
+}
+
+void internal::ProtectJournal::PrintStats(FILE* out) const
+{
+	const size_t saved_count = 2 * m_stats.m_cancel_count;
+	const size_t total_count = m_stats.m_protect_count + m_stats.m_unprotect_count + saved_count;
+	fprintf(out, "protect journal: %lu protects, %lu unprotects, %lu deferred, %lu cancelled, %lu flushes, %lu pending\n",
+		(unsigned long) m_stats.m_protect_count, (unsigned long) m_stats.m_unprotect_count,
+		(unsigned long) m_stats.m_defer_count, (unsigned long) m_stats.m_cancel_count,
+		(unsigned long) m_stats.m_flush_count, (unsigned long) m_pending_count);
+	if (total_count > 0)
+	{
+		fprintf(out, "  %lu JSC calls avoided (%.1f%%)\n", (unsigned long) saved_count, 100.0 * saved_count / total_count);
+	}
+}
+
 /// v8::internal
 
 JSValueRef internal::ExportValue(Handle<Value> value)
 {
-	return value->m_js_value;
+	return value->GetJSValue();
 }
 
 JSObjectRef internal::ExportObject(Handle<Object> object)
@@ -234,13 +849,22 @@ Handle<Value> internal::ImportValue(JSContextRef js_ctx, JSValueRef js_value)
 	if (JSValueIsBoolean(js_ctx, js_value))
 	{
 		// import pure-JS boolean value
-		return Handle<Value>(new Boolean(js_ctx, js_value));
+		internal::ContextCache* cache = Context::GetCurrentCache();
+		return Handle<Value>((JSValueToBoolean(js_ctx, js_value))?(cache->m_true_value):(cache->m_false_value));
 	}
 
 	if (JSValueIsNumber(js_ctx, js_value))
 	{
 		// import pure-JS number value
-		return Handle<Value>(new Number(js_ctx, js_value));
+		double value = JSValueToNumber(js_ctx, js_value, NULL);
+		Integer* integer = Context::GetCurrentCache()->GetSmallInteger(value);
+		if (integer != NULL)
+		{
+			return Handle<Value>(integer);
+		}
+		Number* number = new Number(js_ctx, js_value);
+		number->SetImmediate(Value::kImmediateNumber, value);
+		return Handle<Value>(number);
 	}
 
 	if (JSValueIsString(js_ctx, js_value))
@@ -251,7 +875,8 @@ Handle<Value> internal::ImportValue(JSContextRef js_ctx, JSValueRef js_value)
 
 	// import pure-JS value (null or undefined)
 	assert(JSValueIsNull(js_ctx, js_value) || JSValueIsUndefined(js_ctx, js_value));
-	return Handle<Value>(new Value(js_ctx, js_value));
+	internal::ContextCache* cache = Context::GetCurrentCache();
+	return Handle<Value>((JSValueIsNull(js_ctx, js_value))?(cache->m_null_value):(cache->m_undefined_value));
 }
 
 Handle<Object> internal::ImportObject(JSContextRef js_ctx, JSObjectRef js_object)
@@ -264,60 +889,61 @@ Handle<Object> internal::ImportObject(JSContextRef js_ctx, JSObjectRef js_object
 		return object;
 	}
 
-	#if 0
-
-	if (JSValueIsBooleanObject(js_ctx, js_object))
+	internal::ContextCache* cache = Context::GetCurrentCache();
+	Object* object = cache->FindObject(js_object);
+	if (object == NULL)
 	{
-		// import pure-JS boolean object
-		return Handle<Object>(new BooleanObject(js_ctx, js_object));
+		object = internal::WrapObject(js_ctx, js_object);
+		cache->AddObject(object);
 	}
+	return Handle<Object>(object);
+}
 
-	if (JSValueIsNumberObject(js_ctx, js_object))
-	{
-		// import pure-JS number object
-		return Handle<Object>(new NumberObject(js_ctx, js_object));
-	}
+Object* internal::WrapObject(JSContextRef js_ctx, JSObjectRef js_object)
+{
+	const Value::ObjectKind kind = JSObjectClassify(js_ctx, js_object);
 
-	if (JSValueIsStringObject(js_ctx, js_object))
+	Object* object = NULL;
+	switch (kind)
 	{
+	#if 0
+	case Value::kObjectKindBooleanObject:
+		// import pure-JS boolean object
+		object = new BooleanObject(js_ctx, js_object);
+		break;
+	case Value::kObjectKindNumberObject:
+		// import pure-JS number object
+		object = new NumberObject(js_ctx, js_object);
+		break;
+	case Value::kObjectKindStringObject:
 		// import pure-JS string object
-		return Handle<Object>(new StringObject(js_ctx, js_object, NULL));
-	}
-
+		object = new StringObject(js_ctx, js_object, NULL);
+		break;
 	#endif
-
-	if (JSValueIsArray(js_ctx, js_object))
-	{
+	case Value::kObjectKindArray:
 		// import pure-JS array object
-		return Handle<Object>(new Array(js_ctx, js_object));
-	}
-
-	if (JSValueIsFunction(js_ctx, js_object))
-	{
+		object = new Array(js_ctx, js_object);
+		break;
+	case Value::kObjectKindFunction:
 		// import pure-JS function object
-		return Handle<Object>(new Function(js_ctx, js_object));
-	}
-
-	if (JSValueIsDate(js_ctx, js_object))
-	{
+		object = new Function(js_ctx, js_object);
+		break;
+	case Value::kObjectKindDate:
 		// import pure-JS date object
-		return Handle<Object>(new Date(js_ctx, js_object));
-	}
-
-	if (JSValueIsRegExp(js_ctx, js_object))
-	{
+		object = new Date(js_ctx, js_object);
+		break;
+	case Value::kObjectKindRegExp:
 		// import pure-JS regexp object
-		return Handle<Object>(new RegExp(js_ctx, js_object));
+		object = new RegExp(js_ctx, js_object);
+		break;
+	default:
+		// import pure-JS object (errors and primitive wrappers included)
+		object = new Object(js_ctx, js_object);
+		break;
 	}
 
-	if (JSValueIsError(js_ctx, js_object))
-	{
-		// import pure-JS error object
-		return Handle<Object>(new Object(js_ctx, js_object));
-	}
-
-	// import pure-JS object
-	return Handle<Object>(new Object(js_ctx, js_object));
+	object->m_object_kind = kind; // later Is*() checks read this instead of asking JSC
+	return object;
 }
 
 /// v8::Isolate
@@ -355,18 +981,102 @@ void Isolate::Dispose()
 	return sm_current_isolate;
 }
 
+/// v8::HandleScope
+
+/*static*/ HandleScope* HandleScope::sm_current_scope = NULL;
+/*static*/ std::vector<internal::SmartObject*> HandleScope::sm_handle_array;
+
+HandleScope::HandleScope() :
+	m_previous_scope(sm_current_scope),
+	m_handle_start(sm_handle_array.size()),
+	m_is_closed(false)
+{
+	sm_current_scope = this;
+}
+
+HandleScope::~HandleScope()
+{
+	_Leave();
+}
+
+void HandleScope::_Leave()
+{
+	if (m_is_closed)
+	{
+		return;
+	}
+	m_is_closed = true;
+
+	assert(sm_current_scope == this); // scopes must nest
+	sm_current_scope = m_previous_scope;
+
+	// release the block newest first, the way individual Locals would have unwound
+	while (sm_handle_array.size() > m_handle_start)
+	{
+		internal::SmartObject* object = sm_handle_array.back();
+		sm_handle_array.pop_back();
+		object->DecRef();
+	}
+
+	internal::ProtectJournal* journal = internal::ProtectJournal::GetInstance();
+	if ((sm_current_scope == NULL) || (journal->GetPendingCount() >= internal::ProtectJournal::kFlushThreshold))
+	{
+		journal->Flush();
+	}
+}
+
+/*static*/ int HandleScope::NumberOfHandles()
+{
+	return (int) sm_handle_array.size();
+}
+
+/*static*/ bool HandleScope::_Adopt(internal::SmartObject* object)
+{
+	if (sm_current_scope == NULL)
+	{
+		return false;
+	}
+	if (object != NULL)
+	{
+		object->IncRef();
+		sm_handle_array.push_back(object);
+	}
+	return true;
+}
+
+/*static*/ bool HandleScope::_AdoptCounted(internal::SmartObject* object)
+{
+	if (sm_current_scope == NULL)
+	{
+		return false;
+	}
+	if (object != NULL)
+	{
+		sm_handle_array.push_back(object);
+	}
+	return true;
+}
+
 /// v8::Handle<T>
 
 /// v8::Local<T>
 
 /// v8::Persistent<T>
 
-/// v8::HandleScope
-
 /// v8::Data
 
 RTTI_IMPLEMENT_ROOT(v8::Data);
 
+/*static*/ void* Data::operator new(size_t size)
+{
+	return internal::SlabAllocator::GetInstance()->Allocate(size);
+}
+
+/*static*/ void Data::operator delete(void* ptr, size_t size)
+{
+	internal::SlabAllocator::GetInstance()->Free(ptr, size);
+}
+
 /// v8::Value
 
 RTTI_IMPLEMENT(v8::Value, v8::Data);
@@ -374,14 +1084,18 @@ RTTI_IMPLEMENT(v8::Value, v8::Data);
 Value::Value() :
 	m_js_ctx(NULL), m_js_value(NULL), m_js_ref(0), m_js_is_protected(false),
 	m_is_weak(false), m_weak_callback(NULL), m_weak_parameter(NULL),
-	m_is_independent(false), m_class_id(0), m_is_near_death(false)
+	m_is_independent(false), m_class_id(0), m_is_near_death(false),
+	m_is_immortal(false), m_immediate_type(kImmediateNone), m_immediate_value(0.0),
+	m_object_kind(kObjectKindUnknown)
 {
 }
 
 Value::Value(JSContextRef js_ctx, JSValueRef js_value) :
 	m_js_ctx(NULL), m_js_value(NULL), m_js_ref(0), m_js_is_protected(false),
 	m_is_weak(false), m_weak_callback(NULL), m_weak_parameter(NULL),
-	m_is_independent(false), m_class_id(0), m_is_near_death(false)
+	m_is_independent(false), m_class_id(0), m_is_near_death(false),
+	m_is_immortal(false), m_immediate_type(kImmediateNone), m_immediate_value(0.0),
+	m_object_kind(kObjectKindUnknown)
 {
 	AttachJSContextAndJSValue(js_ctx, js_value);
 }
@@ -401,12 +1115,20 @@ Value::~Value()
 
 void Value::IncRef()
 {
+	if (m_is_immortal)
+	{
+		return;
+	}
 	SmartObject::IncRef();
 	IncJSRef();
 }
 
 void Value::DecRef()
 {
+	if (m_is_immortal)
+	{
+		return;
+	}
 	DecJSRef();
 	SmartObject::DecRef();
 }
@@ -427,6 +1149,11 @@ void Value::_OnDelete()
 
 void Value::_MakeWeak(void* parameter, void (*callback)(Persistent<Value> object, void* parameter))
 {
+	if (m_is_immortal)
+	{
+		return; // never collected, so the callback would never run
+	}
+
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
 	if (!JSValueIsObjectOfClass(js_ctx, m_js_value, Object::GetJSClass()) &&
 		!JSValueIsObjectOfClass(js_ctx, m_js_value, External::GetJSClass()))
@@ -488,10 +1215,14 @@ void Value::IncJSRef()
 {
 	if (m_js_ref++ <= ((m_is_weak)?(1):(0)))
 	{
-		if (!m_js_is_protected)
+		#if V8LIKE_JSVALUE64
+		if (!m_js_is_protected && (m_immediate_type == kImmediateNone) && (m_js_value != NULL)) // immediates are not cells; ropes have no value yet
+		#else
+		if (!m_js_is_protected && (m_js_value != NULL))
+		#endif
 		{
 			m_js_is_protected = true;
-			JSValueProtect(Context::GetCurrentJSGlobalContext(), m_js_value);
+			internal::ProtectJournal::GetInstance()->Protect(Context::GetCurrentJSGlobalContext(), m_js_value);
 		}
 	}
 	assert(m_js_ref > 0); // check for overflow
@@ -505,11 +1236,30 @@ void Value::DecJSRef()
 		if (m_js_is_protected)
 		{
 			m_js_is_protected = false;
-			JSValueUnprotect(Context::GetCurrentJSGlobalContext(), m_js_value);
+			internal::ProtectJournal::GetInstance()->Unprotect(Context::GetCurrentJSGlobalContext(), m_js_value);
 		}
 	}
 }
 
+void Value::MakeImmortal()
+{
+	assert(GetRef() == 0);
+	assert(m_js_ref == 0);
+	m_is_immortal = true;
+	#if !V8LIKE_JSVALUE64
+	// non-cell values cross the C API boxed in a collectable cell, so pin it for good
+	m_js_is_protected = true;
+	JSValueProtect(m_js_ctx, m_js_value);
+	#endif
+}
+
+void Value::SetImmediate(ImmediateType type, double value)
+{
+	assert(m_js_ref == 0);
+	m_immediate_type = type;
+	m_immediate_value = value;
+}
+
 void Value::AttachJSContextAndJSValue(JSContextRef js_ctx, JSValueRef js_value)
 {
 	assert(js_ctx != NULL);
@@ -528,57 +1278,105 @@ void Value::DetachJSContextAndJSValue()
 
 	assert(m_js_value != NULL);
 	m_js_value = NULL;
+	m_object_kind = kObjectKindUnknown;
+
+	if (m_is_weak)
+	{
+		SmartObject::DecRef(); // v8::Value v8::Persistent weak reference
+	}
+}
 
-	if (m_is_weak)
+Value::ObjectKind Value::GetObjectKind()
+{
+	if (m_object_kind == kObjectKindUnknown)
 	{
-		SmartObject::DecRef(); // v8::Value v8::Persistent weak reference
+		m_object_kind = kObjectKindNone;
+		if ((m_immediate_type == kImmediateNone) && (m_js_value != NULL))
+		{
+			JSContextRef js_ctx = Context::GetCurrentJSContext();
+			if (JSValueIsObject(js_ctx, m_js_value))
+			{
+				m_object_kind = JSObjectClassify(js_ctx, JSValueToObject(js_ctx, m_js_value, NULL));
+			}
+		}
 	}
+	return m_object_kind;
 }
 
 bool Value::IsUndefined()
 {
+	if (m_immediate_type != kImmediateNone)
+	{
+		return (m_immediate_type == kImmediateUndefined);
+	}
+
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return JSValueIsUndefined(js_ctx, m_js_value);
+	return JSValueIsUndefined(js_ctx, GetJSValue());
 }
 
 bool Value::IsNull()
 {
+	if (m_immediate_type != kImmediateNone)
+	{
+		return (m_immediate_type == kImmediateNull);
+	}
+
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return JSValueIsNull(js_ctx, m_js_value);
+	return JSValueIsNull(js_ctx, GetJSValue());
 }
 
 bool Value::IsBoolean()
 {
+	if (m_immediate_type != kImmediateNone)
+	{
+		return (m_immediate_type == kImmediateBoolean);
+	}
+
 	if (RTTI_IsKindOf(Boolean, this))
 	{
 		return true;
 	}
 
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return JSValueIsBoolean(js_ctx, m_js_value);
+	return JSValueIsBoolean(js_ctx, GetJSValue());
 }
 
 bool Value::IsFalse()
 {
+	if (m_immediate_type != kImmediateNone)
+	{
+		return (m_immediate_type == kImmediateBoolean) && (m_immediate_value == 0.0);
+	}
+
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return IsBoolean() && !JSValueToBoolean(js_ctx, m_js_value);
+	return IsBoolean() && !JSValueToBoolean(js_ctx, GetJSValue());
 }
 
 bool Value::IsTrue()
 {
+	if (m_immediate_type != kImmediateNone)
+	{
+		return (m_immediate_type == kImmediateBoolean) && (m_immediate_value != 0.0);
+	}
+
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return IsBoolean() && JSValueToBoolean(js_ctx, m_js_value);
+	return IsBoolean() && JSValueToBoolean(js_ctx, GetJSValue());
 }
 
 bool Value::IsNumber()
 {
+	if (m_immediate_type != kImmediateNone)
+	{
+		return (m_immediate_type == kImmediateNumber);
+	}
+
 	if (RTTI_IsKindOf(Number, this))
 	{
 		return true;
 	}
 
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return JSValueIsNumber(js_ctx, m_js_value);
+	return JSValueIsNumber(js_ctx, GetJSValue());
 }
 
 bool Value::IsInt32()
@@ -605,17 +1403,27 @@ bool Value::IsUint32()
 
 bool Value::IsString()
 {
+	if (m_immediate_type != kImmediateNone)
+	{
+		return false;
+	}
+
 	if (RTTI_IsKindOf(String, this))
 	{
 		return true;
 	}
 
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return JSValueIsString(js_ctx, m_js_value);
+	return JSValueIsString(js_ctx, GetJSValue());
 }
 
 bool Value::IsObject()
 {
+	if (m_immediate_type != kImmediateNone)
+	{
+		return false;
+	}
+
 	if (RTTI_IsKindOf(Object, this))
 	{
 		return true;
@@ -627,131 +1435,181 @@ bool Value::IsObject()
 //	{
 //		return true;
 //	}
-	return JSValueIsObject(js_ctx, m_js_value);
+	return JSValueIsObject(js_ctx, GetJSValue());
 }
 
 bool Value::IsArray()
 {
+	if (m_immediate_type != kImmediateNone)
+	{
+		return false;
+	}
+
 	if (RTTI_IsKindOf(Array, this))
 	{
 		return true;
 	}
 
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
+//	JSContextRef js_ctx = Context::GetCurrentJSContext();
 //	assert(!JSValueIsObjectOfClass(js_ctx, m_js_value, Object::GetJSClass()));
 //	if (JSValueIsObjectOfClass(js_ctx, m_js_value, Array::GetJSClass()))
 //	{
 //		return true;
 //	}
-	return JSValueIsArray(js_ctx, m_js_value);
+	return (GetObjectKind() == kObjectKindArray);
 }
 
 bool Value::IsFunction()
 {
+	if (m_immediate_type != kImmediateNone)
+	{
+		return false;
+	}
+
 	if (RTTI_IsKindOf(Function, this))
 	{
 		return true;
 	}
 
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	assert(!JSValueIsObjectOfClass(js_ctx, m_js_value, Function::GetJSClass()));
+	assert(!JSValueIsObjectOfClass(Context::GetCurrentJSContext(), GetJSValue(), Function::GetJSClass()));
 //	if (JSValueIsObjectOfClass(js_ctx, m_js_value, Function::GetJSClass()))
 //	{
 //		return true;
 //	}
-	return JSValueIsFunction(js_ctx, m_js_value);
+	return (GetObjectKind() == kObjectKindFunction);
 }
 
 bool Value::IsExternal()
 {
+	if (m_immediate_type != kImmediateNone)
+	{
+		return false;
+	}
+
 	if (RTTI_IsKindOf(External, this))
 	{
 		return true;
 	}
 
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	assert(!JSValueIsObjectOfClass(js_ctx, m_js_value, External::GetJSClass()));
+	assert(!JSValueIsObjectOfClass(Context::GetCurrentJSContext(), GetJSValue(), External::GetJSClass()));
 //	return JSValueIsObjectOfClass(js_ctx, m_js_value, External::GetJSClass());
 	return false;
 }
 
+bool Value::IsDate()
+{
+	if (m_immediate_type != kImmediateNone)
+	{
+		return false;
+	}
+
+	if (RTTI_IsKindOf(Date, this))
+	{
+		return true;
+	}
+
+	return (GetObjectKind() == kObjectKindDate);
+}
+
 bool Value::IsRegExp()
 {
+	if (m_immediate_type != kImmediateNone)
+	{
+		return false;
+	}
+
 	if (RTTI_IsKindOf(RegExp, this))
 	{
 		return true;
 	}
 
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	assert(!JSValueIsObjectOfClass(js_ctx, m_js_value, Object::GetJSClass()));
+	assert(!JSValueIsObjectOfClass(Context::GetCurrentJSContext(), GetJSValue(), Object::GetJSClass()));
 //	if (JSValueIsObjectOfClass(js_ctx, m_js_value, RegExp::GetJSClass()))
 //	{
 //		return true;
 //	}
-	return JSValueIsRegExp(js_ctx, m_js_value);
+	return (GetObjectKind() == kObjectKindRegExp);
 }
 
 bool Value::IsNativeError()
 {
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return JSValueIsError(js_ctx, m_js_value);
+	if (m_immediate_type != kImmediateNone)
+	{
+		return false;
+	}
+
+	return (GetObjectKind() == kObjectKindNativeError);
 }
 
 bool Value::IsBooleanObject()
 {
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return JSValueIsBooleanObject(js_ctx, m_js_value);
+	if (m_immediate_type != kImmediateNone)
+	{
+		return false;
+	}
+
+	return (GetObjectKind() == kObjectKindBooleanObject);
 }
 
 bool Value::IsNumberObject()
 {
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return JSValueIsNumberObject(js_ctx, m_js_value);
+	if (m_immediate_type != kImmediateNone)
+	{
+		return false;
+	}
+
+	return (GetObjectKind() == kObjectKindNumberObject);
 }
 
 bool Value::IsStringObject()
 {
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return JSValueIsStringObject(js_ctx, m_js_value);
+	if (m_immediate_type != kImmediateNone)
+	{
+		return false;
+	}
+
+	return (GetObjectKind() == kObjectKindStringObject);
 }
 
 Local<Boolean> Value::ToBoolean() const
 {
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	JSValueRef js_value = JSValueMakeBoolean(js_ctx, JSValueToBoolean(js_ctx, m_js_value));
-	return Local<Boolean>(new Boolean(js_ctx, js_value));
+	internal::ContextCache* cache = Context::GetCurrentCache();
+	return Local<Boolean>((BooleanValue())?(cache->m_true_value):(cache->m_false_value));
 }
 
 Local<Number> Value::ToNumber() const
 {
-	JSValueRef js_exception = NULL;
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	JSValueRef js_value = JSValueMakeNumber(js_ctx, JSValueToNumber(js_ctx, m_js_value, &js_exception));
-	return Local<Number>(new Number(js_ctx, js_value));
+	return Number::New(NumberValue());
 }
 
 Local<Integer> Value::ToInteger() const
 {
 	JSValueRef js_exception = NULL;
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	JSValueRef js_value = JSValueMakeNumber(js_ctx, JSValueToNumber(js_ctx, m_js_value, &js_exception));
-	return Local<Integer>(new Integer(js_ctx, js_value));
+	double value = JSValueToNumber(js_ctx, GetJSValue(), &js_exception);
+	Integer* number = new Integer(js_ctx, JSValueMakeNumber(js_ctx, value));
+	number->SetImmediate(kImmediateNumber, value);
+	return Local<Integer>(number);
 }
 
 Local<Int32> Value::ToInt32() const
 {
 	JSValueRef js_exception = NULL;
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	JSValueRef js_value = JSValueMakeNumber(js_ctx, JSValueToNumber(js_ctx, m_js_value, &js_exception));
-	return Local<Int32>(new Int32(js_ctx, js_value));
+	double value = JSValueToNumber(js_ctx, GetJSValue(), &js_exception);
+	Int32* number = new Int32(js_ctx, JSValueMakeNumber(js_ctx, value));
+	number->SetImmediate(kImmediateNumber, value);
+	return Local<Int32>(number);
 }
 
 Local<Uint32> Value::ToUint32() const
 {
 	JSValueRef js_exception = NULL;
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	JSValueRef js_value = JSValueMakeNumber(js_ctx, JSValueToNumber(js_ctx, m_js_value, &js_exception));
-	return Local<Uint32>(new Uint32(js_ctx, js_value));
+	double value = JSValueToNumber(js_ctx, GetJSValue(), &js_exception);
+	Uint32* number = new Uint32(js_ctx, JSValueMakeNumber(js_ctx, value));
+	number->SetImmediate(kImmediateNumber, value);
+	return Local<Uint32>(number);
 }
 
 Local<Uint32> Value::ToArrayIndex() const
@@ -763,7 +1621,7 @@ Local<String> Value::ToString() const
 {
 	JSValueRef js_exception = NULL;
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	JSStringRef js_string = JSValueToStringCopy(js_ctx, m_js_value, &js_exception);
+	JSStringRef js_string = JSValueToStringCopy(js_ctx, GetJSValue(), &js_exception);
 	JSValueRef js_value = JSValueMakeString(js_ctx, js_string);
 	JSStringRelease(js_string); js_string = NULL;
 	if (js_exception == NULL)
@@ -783,14 +1641,14 @@ Local<Object> Value::ToObject() const
 	JSValueRef js_exception = NULL;
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
 
-	if (JSValueIsObjectOfClass(js_ctx, m_js_value, Object::GetJSClass()))
+	if (JSValueIsObjectOfClass(js_ctx, GetJSValue(), Object::GetJSClass()))
 	{
-		JSObjectRef js_object = JSValueToObject(js_ctx, m_js_value, NULL);
-		assert(js_object == m_js_value);
+		JSObjectRef js_object = JSValueToObject(js_ctx, GetJSValue(), NULL);
+		assert(js_object == GetJSValue());
 		return Local<Object>((Object*) JSObjectGetPrivate(js_object));
 	}
 
-	JSObjectRef js_object = JSValueToObject(js_ctx, m_js_value, &js_exception);
+	JSObjectRef js_object = JSValueToObject(js_ctx, GetJSValue(), &js_exception);
 	if (js_exception == NULL)
 	{
 		return Local<Object>(internal::ImportObject(js_ctx, js_object));
@@ -801,15 +1659,33 @@ Local<Object> Value::ToObject() const
 
 bool Value::BooleanValue() const
 {
+	switch (m_immediate_type)
+	{
+	case kImmediateUndefined:	return false;
+	case kImmediateNull:		return false;
+	case kImmediateBoolean:		return (m_immediate_value != 0.0);
+	case kImmediateNumber:		return !((m_immediate_value == 0.0) || std::isnan(m_immediate_value));
+	default: break;
+	}
+
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return JSValueToBoolean(js_ctx, m_js_value);
+	return JSValueToBoolean(js_ctx, GetJSValue());
 }
 
 double Value::NumberValue() const
 {
+	switch (m_immediate_type)
+	{
+	case kImmediateUndefined:	return std::numeric_limits<double>::quiet_NaN();
+	case kImmediateNull:		return 0.0;
+	case kImmediateBoolean:		return m_immediate_value;
+	case kImmediateNumber:		return m_immediate_value;
+	default: break;
+	}
+
 	JSValueRef js_exception = NULL;
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return JSValueToNumber(js_ctx, m_js_value, &js_exception);
+	return JSValueToNumber(js_ctx, GetJSValue(), &js_exception);
 }
 
 int64_t Value::IntegerValue() const
@@ -829,19 +1705,34 @@ uint32_t Value::Uint32Value() const
 
 bool Value::Equals(Handle<Value> that) const
 {
+	if ((m_immediate_type != kImmediateNone) && (that->m_immediate_type != kImmediateNone))
+	{
+		bool is_nullish = (m_immediate_type == kImmediateUndefined) || (m_immediate_type == kImmediateNull);
+		bool that_is_nullish = (that->m_immediate_type == kImmediateUndefined) || (that->m_immediate_type == kImmediateNull);
+		if (is_nullish || that_is_nullish)
+		{
+			return (is_nullish && that_is_nullish);
+		}
+		return (m_immediate_value == that->m_immediate_value); // booleans compare as numbers
+	}
+
 	JSValueRef js_exception = NULL;
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return JSValueIsEqual(js_ctx, m_js_value, that->m_js_value, &js_exception);
+	return JSValueIsEqual(js_ctx, GetJSValue(), that->GetJSValue(), &js_exception);
 }
 
 bool Value::StrictEquals(Handle<Value> that) const
 {
-	if (m_js_value == that->m_js_value)
+	if (GetJSValue() == that->GetJSValue())
 	{
 		return true;
 	}
+	if ((m_immediate_type != kImmediateNone) && (that->m_immediate_type != kImmediateNone))
+	{
+		return (m_immediate_type == that->m_immediate_type) && (m_immediate_value == that->m_immediate_value);
+	}
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return JSValueIsStrictEqual(js_ctx, m_js_value, that->m_js_value);
+	return JSValueIsStrictEqual(js_ctx, GetJSValue(), that->GetJSValue());
 }
 
 /// v8::Primitive
@@ -854,14 +1745,19 @@ RTTI_IMPLEMENT(v8::Boolean, v8::Primitive);
 
 bool Boolean::Value() const
 {
+	if (m_immediate_type == kImmediateBoolean)
+	{
+		return (m_immediate_value != 0.0);
+	}
+
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return JSValueToBoolean(js_ctx, m_js_value);
+	return JSValueToBoolean(js_ctx, GetJSValue());
 }
 
 /*static*/ Handle<Boolean> Boolean::New(bool value)
 {
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return Handle<Boolean>(new Boolean(js_ctx, JSValueMakeBoolean(js_ctx, value)));
+	internal::ContextCache* cache = Context::GetCurrentCache();
+	return Handle<Boolean>((value)?(cache->m_true_value):(cache->m_false_value));
 }
 
 /*static*/ Boolean* Boolean::Cast(v8::Value* value)
@@ -874,10 +1770,11 @@ bool Boolean::Value() const
 	if (value)
 	{
 		JSContextRef js_ctx = Context::GetCurrentJSContext();
-		JSValueRef js_value = value->m_js_value;
+		JSValueRef js_value = value->GetJSValue();
 		if (JSValueIsBoolean(js_ctx, js_value))
 		{
-			return new Boolean(js_ctx, js_value);
+			internal::ContextCache* cache = Context::GetCurrentCache();
+			return (JSValueToBoolean(js_ctx, js_value))?(cache->m_true_value):(cache->m_false_value);
 		}
 	}
 	return NULL;
@@ -889,15 +1786,28 @@ RTTI_IMPLEMENT(v8::Number, v8::Primitive);
 
 double Number::Value() const
 {
+	if (m_immediate_type == kImmediateNumber)
+	{
+		return m_immediate_value;
+	}
+
 	JSValueRef js_exception = NULL;
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return JSValueToNumber(js_ctx, m_js_value, &js_exception);
+	return JSValueToNumber(js_ctx, GetJSValue(), &js_exception);
 }
 
 /*static*/ Local<Number> Number::New(double value)
 {
+	Integer* integer = Context::GetCurrentCache()->GetSmallInteger(value);
+	if (integer != NULL)
+	{
+		return Local<Number>(integer);
+	}
+
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return Local<Number>(new Number(js_ctx, JSValueMakeNumber(js_ctx, value)));
+	Number* number = new Number(js_ctx, JSValueMakeNumber(js_ctx, value));
+	number->SetImmediate(kImmediateNumber, value);
+	return Local<Number>(number);
 }
 
 /*static*/ Number* Number::Cast(v8::Value* value)
@@ -910,7 +1820,7 @@ double Number::Value() const
 	if (value)
 	{
 		JSContextRef js_ctx = Context::GetCurrentJSContext();
-		JSValueRef js_value = value->m_js_value;
+		JSValueRef js_value = value->GetJSValue();
 		if (JSValueIsNumber(js_ctx, js_value))
 		{
 			return new Number(js_ctx, js_value);
@@ -925,21 +1835,42 @@ RTTI_IMPLEMENT(v8::Integer, v8::Number);
 
 int64_t Integer::Value() const
 {
+	if (m_immediate_type == kImmediateNumber)
+	{
+		return internal::DoubleToInteger(m_immediate_value);
+	}
+
 	JSValueRef js_exception = NULL;
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return internal::DoubleToInteger(JSValueToNumber(js_ctx, m_js_value, &js_exception));
+	return internal::DoubleToInteger(JSValueToNumber(js_ctx, GetJSValue(), &js_exception));
 }
 
 /*static*/ Local<Integer> Integer::New(int32_t value)
 {
+	Integer* integer = Context::GetCurrentCache()->GetSmallInteger(internal::FastI2D(value));
+	if (integer != NULL)
+	{
+		return Local<Integer>(integer);
+	}
+
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return Local<Integer>(new Integer(js_ctx, JSValueMakeNumber(js_ctx, internal::FastI2D(value))));
+	Integer* number = new Integer(js_ctx, JSValueMakeNumber(js_ctx, internal::FastI2D(value)));
+	number->SetImmediate(kImmediateNumber, internal::FastI2D(value));
+	return Local<Integer>(number);
 }
 
 /*static*/ Local<Integer> Integer::NewFromUnsigned(uint32_t value)
 {
+	Integer* integer = Context::GetCurrentCache()->GetSmallInteger(internal::FastUI2D(value));
+	if (integer != NULL)
+	{
+		return Local<Integer>(integer);
+	}
+
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return Local<Integer>(new Integer(js_ctx, JSValueMakeNumber(js_ctx, internal::FastUI2D(value))));
+	Integer* number = new Integer(js_ctx, JSValueMakeNumber(js_ctx, internal::FastUI2D(value)));
+	number->SetImmediate(kImmediateNumber, internal::FastUI2D(value));
+	return Local<Integer>(number);
 }
 
 /*static*/ Integer* Integer::Cast(v8::Value* value)
@@ -947,7 +1878,7 @@ int64_t Integer::Value() const
 	if (value)
 	{
 		JSContextRef js_ctx = Context::GetCurrentJSContext();
-		JSValueRef js_value = value->m_js_value;
+		JSValueRef js_value = value->GetJSValue();
 		if (JSValueIsNumber(js_ctx, js_value))
 		{
 			return new Integer(js_ctx, js_value);
@@ -962,9 +1893,14 @@ RTTI_IMPLEMENT(v8::Int32, v8::Integer);
 
 int32_t Int32::Value() const
 {
+	if (m_immediate_type == kImmediateNumber)
+	{
+		return internal::DoubleToInt32(m_immediate_value);
+	}
+
 	JSValueRef js_exception = NULL;
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return internal::DoubleToInt32(JSValueToNumber(js_ctx, m_js_value, &js_exception));
+	return internal::DoubleToInt32(JSValueToNumber(js_ctx, GetJSValue(), &js_exception));
 }
 
 /// v8::Uint32
@@ -973,30 +1909,50 @@ RTTI_IMPLEMENT(v8::Uint32, v8::Integer);
 
 uint32_t Uint32::Value() const
 {
+	if (m_immediate_type == kImmediateNumber)
+	{
+		return internal::DoubleToUint32(m_immediate_value);
+	}
+
 	JSValueRef js_exception = NULL;
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return internal::DoubleToUint32(JSValueToNumber(js_ctx, m_js_value, &js_exception));
+	return internal::DoubleToUint32(JSValueToNumber(js_ctx, GetJSValue(), &js_exception));
 }
 
 /// v8::String::Utf8Value
 
 String::Utf8Value::Utf8Value(Handle<v8::Value> value) : m_str(NULL), m_length(0)
 {
+	if (RTTI_IsKindOf(String, *value))
+	{
+		// a string wrapper already holds its content and knows its encoded size
+		String* string = RTTI_StaticCast(String, *value);
+		JSStringRef js_string = string->_GetJSString();
+		const size_t size = (size_t) string->_GetUtf8Length();
+		m_str = new char[size + 1];
+		assert(m_str);
+		m_length = (int) JSCharEncodeUtf8(m_str, size, JSStringGetCharactersPtr(js_string), JSStringGetLength(js_string), NULL, false);
+		assert(m_length == (int) size);
+		m_str[m_length] = 0;
+		return;
+	}
+
 	JSValueRef js_exception = NULL;
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	JSValueRef js_value = value->m_js_value;
+	JSValueRef js_value = value->GetJSValue();
 	JSStringRef js_string = JSValueToStringCopy(js_ctx, js_value, &js_exception);
 	if (!js_exception)
 	{
-		size_t size = JSStringGetMaximumUTF8CStringSize(js_string);
-		m_str = new char[size];
+		const JSChar* js_data = JSStringGetCharactersPtr(js_string);
+		const size_t js_length = JSStringGetLength(js_string);
+		const size_t size = JSCharUtf8Length(js_data, js_length);
+		m_str = new char[size + 1];
 		assert(m_str);
 		if (m_str)
 		{
-			m_str[0] = 0;
-			// NOTE: bytes_written includes the null-terminator byte
-			size_t bytes_written = JSStringGetUTF8CString(js_string, m_str, size);
-			m_length = (int)(bytes_written - 1);
+			m_length = (int) JSCharEncodeUtf8(m_str, size, js_data, js_length, NULL, false);
+			assert(m_length == (int) size);
+			m_str[m_length] = 0;
 		}
 	}
 	JSStringRelease(js_string); js_string = NULL;
@@ -1016,7 +1972,7 @@ String::AsciiValue::AsciiValue(Handle<v8::Value> value) : m_str(NULL), m_length(
 {
 	JSValueRef js_exception = NULL;
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	JSValueRef js_value = value->m_js_value;
+	JSValueRef js_value = value->GetJSValue();
 	JSStringRef js_string = JSValueToStringCopy(js_ctx, js_value, &js_exception);
 	if (!js_exception)
 	{
@@ -1044,36 +2000,85 @@ String::AsciiValue::~AsciiValue()
 
 /// v8::String::Value
 
-String::Value::Value(Handle<v8::Value> value) : m_str(NULL), m_length(0)
+// retains the string content of value, NULL if the conversion threw
+static JSStringRef JSStringRetainContent(Handle<v8::Value> value)
 {
-	// TODO
-///	JSValueRef js_exception = NULL;
-///	JSContextRef js_ctx = Context::GetCurrentJSContext();
-///	JSValueRef js_value = value->m_js_value;
-///	JSStringRef js_string = JSValueToStringCopy(js_ctx, js_value, &js_exception);
-///	if (!js_exception)
-///	{
-///		size_t size = JSStringGetMaximumUTF8CStringSize(js_string);
-///		m_str = new char[size];
-///		assert(m_str);
-///		if (m_str)
-///		{
-///			m_str[0] = 0;
-///			// NOTE: bytes_written includes the null-terminator byte
-///			size_t bytes_written = JSStringGetUTF8CString(js_string, m_str, size);
-///			m_length = (int)(bytes_written - 1);
-///		}
-///	}
-///	JSStringRelease(js_string); js_string = NULL;
+	if (RTTI_IsKindOf(String, *value))
+	{
+		// a string wrapper already holds its content, so no conversion is needed
+		return JSStringRetain(RTTI_StaticCast(String, *value)->_GetJSString());
+	}
+
+	JSValueRef js_exception = NULL;
+	JSContextRef js_ctx = Context::GetCurrentJSContext();
+	JSStringRef js_string = JSValueToStringCopy(js_ctx, value->GetJSValue(), &js_exception);
+	if (js_exception && js_string)
+	{
+		JSStringRelease(js_string); js_string = NULL;
+	}
+	return js_string;
+}
+
+String::Value::Value(Handle<v8::Value> value) : m_js_string(NULL), m_buffer(NULL), m_length(0)
+{
+	m_js_string = JSStringRetainContent(value);
+	if (m_js_string)
+	{
+		m_length = (int) JSStringGetLength(m_js_string);
+	}
 }
 
 String::Value::~Value()
 {
-	// TODO
-///	if (m_str)
-///	{
-///		delete[] m_str; m_str = NULL;
-///	}
+	if (m_buffer)
+	{
+		delete[] m_buffer; m_buffer = NULL;
+	}
+	if (m_js_string)
+	{
+		JSStringRelease(m_js_string); m_js_string = NULL;
+	}
+}
+
+uint16_t* String::Value::_GetBuffer() const
+{
+	// the JSStringRef characters are shared and not null-terminated, so both accessors copy
+	if (!m_buffer && m_js_string)
+	{
+		m_buffer = new uint16_t[m_length + 1];
+		assert(m_buffer);
+		memcpy(m_buffer, JSStringGetCharactersPtr(m_js_string), m_length * sizeof(uint16_t));
+		m_buffer[m_length] = 0;
+	}
+	return m_buffer;
+}
+
+/// v8::String::View
+
+String::View::View(Handle<v8::Value> value) : m_js_string(NULL), m_str(NULL), m_length(0)
+{
+	m_js_string = JSStringRetainContent(value);
+	if (m_js_string)
+	{
+		m_str = (const uint16_t*) JSStringGetCharactersPtr(m_js_string);
+		m_length = (int) JSStringGetLength(m_js_string);
+	}
+}
+
+String::View::View(const View& other) : m_js_string(other.m_js_string), m_str(other.m_str), m_length(other.m_length)
+{
+	if (m_js_string)
+	{
+		JSStringRetain(m_js_string);
+	}
+}
+
+String::View::~View()
+{
+	if (m_js_string)
+	{
+		JSStringRelease(m_js_string); m_js_string = NULL;
+	}
 }
 
 /// v8::String
@@ -1081,165 +2086,361 @@ String::Value::~Value()
 RTTI_IMPLEMENT(v8::String, v8::Primitive);
 
 String::String(JSContextRef js_ctx, JSValueRef js_value) :
-	Primitive(js_ctx, js_value)
+	Primitive(js_ctx, js_value),
+	m_js_string(NULL), m_length(-1), m_utf8_length(-1), m_is_ascii(-1), m_is_symbol(false), m_hash(0), m_is_hashed(false),
+	m_rope_depth(0)
+{
+}
+
+String::String(JSContextRef js_ctx, JSStringRef js_string) :
+	m_js_string(JSStringRetain(js_string)), m_length(-1), m_utf8_length(-1), m_is_ascii(-1), m_is_symbol(false), m_hash(0), m_is_hashed(false),
+	m_rope_depth(0)
+{
+	m_js_ctx = js_ctx; // the JS value is made by _Materialize, if it is ever needed
+}
+
+String::String(JSContextRef js_ctx, Handle<String> left, Handle<String> right) :
+	m_js_string(NULL), m_length(left->_GetLength() + right->_GetLength()), m_utf8_length(-1), m_is_ascii(-1), m_is_symbol(false), m_hash(0), m_is_hashed(false),
+	m_rope_left(left), m_rope_right(right),
+	m_rope_depth(((left->m_rope_depth > right->m_rope_depth)?(left->m_rope_depth):(right->m_rope_depth)) + 1)
 {
+	m_js_ctx = js_ctx; // the JS value is made by _Materialize
+	if ((left->m_is_ascii == 1) && (right->m_is_ascii == 1))
+	{
+		m_is_ascii = 1;
+		m_utf8_length = m_length;
+	}
 }
 
 String::~String()
 {
+	if (m_js_string != NULL)
+	{
+		JSStringRelease(m_js_string); m_js_string = NULL;
+	}
+
+	// release the operands without recursing: an operand this rope holds the last reference to
+	// hands its own operands over before it goes, so a long append chain unwinds in a loop
+	if (m_rope_depth > 0)
+	{
+		std::vector<Handle<String> > stack;
+		stack.push_back(m_rope_left);
+		stack.push_back(m_rope_right);
+		m_rope_left = Handle<String>();
+		m_rope_right = Handle<String>();
+		while (!stack.empty())
+		{
+			Handle<String> node = stack.back();
+			stack.pop_back();
+			if ((node->m_rope_depth > 0) && (node->GetRef() == 1))
+			{
+				stack.push_back(node->m_rope_left);
+				stack.push_back(node->m_rope_right);
+				node->m_rope_left = Handle<String>();
+				node->m_rope_right = Handle<String>();
+				node->m_rope_depth = 0;
+			}
+		}
+	}
+}
+
+JSStringRef String::_GetJSString() const
+{
+	if (m_js_string == NULL)
+	{
+		if (m_rope_depth > 0)
+		{
+			_Flatten();
+		}
+		else
+		{
+			m_js_string = JSValueToStringCopy(m_js_ctx, m_js_value, NULL);
+		}
+		assert(m_js_string != NULL);
+	}
+	return m_js_string;
 }
 
-int String::Length()
+void String::_Flatten() const
 {
-	int length = 0;
+	assert(m_rope_depth > 0);
 
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	JSStringRef js_string = JSValueToStringCopy(js_ctx, m_js_value, NULL);
+	// one copy of every leaf, left to right, without recursing
+	JSChar* buffer = new JSChar[(m_length > 0)?(m_length):(1)];
+	size_t pos = 0;
+	std::vector<const String*> stack;
+	stack.push_back(this);
+	while (!stack.empty())
+	{
+		const String* node = stack.back();
+		stack.pop_back();
+		if (node->m_rope_depth > 0)
+		{
+			stack.push_back(*node->m_rope_right);
+			stack.push_back(*node->m_rope_left);
+		}
+		else
+		{
+			JSStringRef js_string = node->_GetJSString();
+			const size_t length = JSStringGetLength(js_string);
+			memcpy(buffer + pos, JSStringGetCharactersPtr(js_string), length * sizeof(JSChar));
+			pos += length;
+		}
+	}
+	assert(pos == (size_t) m_length);
+
+	m_js_string = JSStringCreateWithCharacters(buffer, pos);
+	delete[] buffer; buffer = NULL;
+
+	m_rope_left = Handle<String>();
+	m_rope_right = Handle<String>();
+	m_rope_depth = 0;
+}
+
+void String::_Materialize()
+{
+	if ((m_js_value != NULL) || (m_js_ctx == NULL) || ((m_rope_depth == 0) && (m_js_string == NULL)))
+	{
+		return;
+	}
+
+	m_js_value = JSValueMakeString(m_js_ctx, _GetJSString());
 
-	if (js_string)
+	// references taken while this was a rope could not protect anything yet
+	if (!m_js_is_protected && (m_js_ref > ((m_is_weak)?(1u):(0u))))
 	{
-		length = (int) JSStringGetLength(js_string);
+		m_js_is_protected = true;
+		internal::ProtectJournal::GetInstance()->Protect(Context::GetCurrentJSGlobalContext(), m_js_value);
 	}
+}
 
-	JSStringRelease(js_string);
+int String::_GetLength() const
+{
+	if (m_length < 0)
+	{
+		m_length = (int) JSStringGetLength(_GetJSString());
+	}
+	return m_length;
+}
 
-	return length;
+int String::_GetUtf8Length() const
+{
+	if (m_utf8_length < 0)
+	{
+		JSStringRef js_string = _GetJSString();
+		m_utf8_length = (int) JSCharUtf8Length(JSStringGetCharactersPtr(js_string), JSStringGetLength(js_string));
+		m_is_ascii = (m_utf8_length == _GetLength())?(1):(0);
+	}
+	return m_utf8_length;
 }
 
-int String::Utf8Length()
+uint32_t String::_GetHash() const
 {
-	int length = 0;
+	if (!m_is_hashed)
+	{
+		JSStringRef js_string = _GetJSString();
+		m_hash = JSCharHash(JSStringGetCharactersPtr(js_string), JSStringGetLength(js_string));
+		m_is_hashed = true;
+	}
+	return m_hash;
+}
 
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	JSStringRef js_string = JSValueToStringCopy(js_ctx, m_js_value, NULL);
+bool String::_ContentEquals(const String* other) const
+{
+	if (other == this)
+	{
+		return true;
+	}
+	if ((_GetLength() != other->_GetLength()) || (_GetHash() != other->_GetHash()))
+	{
+		return false;
+	}
+	return (memcmp(JSStringGetCharactersPtr(_GetJSString()), JSStringGetCharactersPtr(other->_GetJSString()), _GetLength() * sizeof(JSChar)) == 0);
+}
 
-	if (js_string)
+bool String::_IsAscii() const
+{
+	if (m_is_ascii < 0)
 	{
-		size_t size = JSStringGetMaximumUTF8CStringSize(js_string);
-		char* str = new char[size];
-		assert(str);
-		// NOTE: bytes_written includes the null-terminator byte
-		size_t bytes_written = JSStringGetUTF8CString(js_string, str, size);
-		delete[] str; str = NULL;
-		length = (int) bytes_written;
+		JSStringRef js_string = _GetJSString();
+		const size_t length = JSStringGetLength(js_string);
+		m_is_ascii = (JSCharCountAscii(JSStringGetCharactersPtr(js_string), length) == length)?(1):(0);
+		if (m_is_ascii)
+		{
+			m_utf8_length = (int) length;
+		}
 	}
+	return (m_is_ascii != 0);
+}
 
-	JSStringRelease(js_string);
+int String::Length()
+{
+	return _GetLength();
+}
 
-	return length;
+int String::Utf8Length()
+{
+	return _GetUtf8Length();
 }
 
 bool String::MayContainNonAscii() const
 {
-	/*TODO();*/ return true;
+	return !_IsAscii();
 }
 
 int String::Write(uint16_t* buffer, int start, int length, int options) const
 {
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	JSStringRef js_string = JSValueToStringCopy(js_ctx, m_js_value, NULL);
-
 	assert(buffer != NULL);
 	assert(start >= 0);
-	assert(length >= 0); // TODO: handle length == -1
 
-	const JSChar* in_buffer = JSStringGetCharactersPtr(js_string);
-	size_t in_length = JSStringGetLength(js_string);
+	// HINT_MANY_WRITES_EXPECTED needs nothing more: the flat content is cached after the first write
+	JSStringRef js_string = _GetJSString();
+	const int in_length = (int) JSStringGetLength(js_string);
+
+	// as V8: clamp to the end of the string, length == -1 writes to the end
+	int end = start + length;
+	if ((length < 0) || (length > (in_length - start)))
+	{
+		end = in_length;
+	}
+	const int count = (end > start)?(end - start):(0);
 
-	for (int i = 0; i < length; ++i)
+	if (count > 0)
 	{
-		assert((start + i) < in_length);
-		buffer[i] = in_buffer[start + i];
+		memcpy(buffer, JSStringGetCharactersPtr(js_string) + start, count * sizeof(uint16_t));
 	}
 
-	JSStringRelease(js_string);
+	if (!(options & NO_NULL_TERMINATION) && ((length < 0) || (count < length)))
+	{
+		buffer[count] = 0;
+	}
 
-	return length;
+	return count;
 }
 
 int String::WriteAscii(char* buffer, int start, int length, int options) const
 {
 	assert(buffer != NULL);
 	assert(start >= 0);
-	assert(length >= 0); // TODO: handle length == -1
 
-	TODO();
+	JSStringRef js_string = _GetJSString();
+	const int in_length = (int) JSStringGetLength(js_string);
 
-	return 0;
+	// as V8: characters are truncated to their low byte, length == -1 writes to the end
+	int end = length;
+	if ((length < 0) || (length > (in_length - start)))
+	{
+		end = in_length - start;
+	}
+	if (end < 0)
+	{
+		return 0;
+	}
+
+	JSCharNarrow(buffer, JSStringGetCharactersPtr(js_string) + start, (size_t) end);
+
+	if (!(options & PRESERVE_ASCII_NULL))
+	{
+		for (char* nul = (char*) memchr(buffer, 0, end); nul != NULL; nul = (char*) memchr(nul + 1, 0, (buffer + end) - (nul + 1)))
+		{
+			*nul = ' ';
+		}
+	}
+
+	if (!(options & NO_NULL_TERMINATION) && ((length < 0) || (end < length)))
+	{
+		buffer[end] = 0;
+	}
+
+	return end;
 }
 
 int String::WriteUtf8(char* buffer, int length, int* nchars_ref, int options) const
 {
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	JSStringRef js_string = JSValueToStringCopy(js_ctx, m_js_value, NULL);
+	JSStringRef js_string = _GetJSString();
 
 	assert(buffer != NULL);
-	assert(length >= 0); // TODO: handle length == -1
-
-	size_t size = JSStringGetMaximumUTF8CStringSize(js_string);
-	char* str = new char[size];
-	assert(str);
-	memset(str, 0, size);
-
-	// NOTE: bytes_written includes the null-terminator byte
-	size_t bytes_written = JSStringGetUTF8CString(js_string, str, size);
 
-	strncpy(buffer, str, length);
-	delete[] str; str = NULL;
+	// length == -1 means the caller sized the buffer from Utf8Length() + 1
+	const size_t capacity = (length < 0)?(std::numeric_limits<size_t>::max()):((size_t) length);
+	const size_t in_length = JSStringGetLength(js_string);
+	size_t nchars = 0;
+	size_t bytes_written = 0;
+	if (m_is_ascii == 1)
+	{
+		// known ASCII: one byte per character, no scanning
+		nchars = bytes_written = (in_length < capacity)?(in_length):(capacity);
+		JSCharNarrow(buffer, JSStringGetCharactersPtr(js_string), bytes_written);
+	}
+	else
+	{
+		bytes_written = JSCharEncodeUtf8(buffer, capacity, JSStringGetCharactersPtr(js_string), in_length, &nchars, (options & REPLACE_INVALID_UTF8) != 0);
+		if ((m_is_ascii < 0) && (nchars == in_length))
+		{
+			m_is_ascii = (bytes_written == in_length)?(1):(0); // learned for free from a complete write
+		}
+	}
 
-	if (options & NO_NULL_TERMINATION)
+	// as in V8 3.14, the terminator is written only after the whole string and only when it
+	// fits, and then counts as written; a truncated write is left unterminated
+	if (!(options & NO_NULL_TERMINATION) && (nchars == in_length) && (bytes_written < capacity))
 	{
-		--bytes_written;
+		buffer[bytes_written++] = 0;
 	}
 
 	if (nchars_ref != NULL)
 	{
-		*nchars_ref = (int) bytes_written;
+		*nchars_ref = (int) nchars;
 	}
 
-	JSStringRelease(js_string);
-
 	return (int) bytes_written;
 }
 
+// the C API cannot create a string that borrows a caller's buffer, so NewExternal
+// copies the characters and disposes the resource; no string is external
 bool String::IsExternal() const
 {
-	TODO(); return false;
+	return false;
 }
 
 bool String::IsExternalAscii() const
 {
-	TODO(); return false;
+	return false;
 }
 
 String::ExternalStringResourceBase* String::GetExternalStringResourceBase(String::Encoding* encoding_out) const
 {
-	TODO(); return NULL;
+	if (encoding_out != NULL)
+	{
+		*encoding_out = UNKNOWN_ENCODING;
+	}
+	return NULL;
 }
 
 String::ExternalStringResource* String::GetExternalStringResource() const
 {
-	TODO(); return NULL;
+	return NULL;
 }
 
 const String::ExternalAsciiStringResource* String::GetExternalAsciiStringResource() const
 {
-	TODO(); return NULL;
+	return NULL;
 }
 
 bool String::MakeExternal(String::ExternalStringResource* resource)
 {
-	TODO(); return false;
+	// refused, so the resource stays with the caller
+	return false;
 }
 
 bool String::MakeExternal(String::ExternalAsciiStringResource* resource)
 {
-	TODO(); return false;
+	return false;
 }
 
 bool String::CanMakeExternal()
 {
-	TODO(); return false;
+	return false;
 }
 
 /*static*/ Local<String> String::Empty()
@@ -1257,7 +2458,7 @@ bool String::CanMakeExternal()
 	if (value)
 	{
 		JSContextRef js_ctx = Context::GetCurrentJSContext();
-		JSValueRef js_value = value->m_js_value;
+		JSValueRef js_value = value->GetJSValue();
 		if (JSValueIsString(js_ctx, js_value))
 		{
 			return new String(js_ctx, js_value);
@@ -1274,19 +2475,7 @@ bool String::CanMakeExternal()
 	{
 		if (length >= 0)
 		{
-			JSChar* buffer = new JSChar[length];
-			assert(buffer);
-
-			for (int i = 0; i < length; ++i)
-			{
-				buffer[i] = data[i];
-			}
-
-			js_string = JSStringCreateWithCharacters(buffer, (size_t) length);
-			assert(JSStringGetCharactersPtr(js_string) != buffer);
-			assert(JSStringGetLength(js_string) == (size_t) length);
-
-			delete[] buffer; buffer = NULL;
+			js_string = JSStringCreateWithUtf8(data, (size_t) length);
 		}
 		else
 		{
@@ -1299,7 +2488,7 @@ bool String::CanMakeExternal()
 
 	JSStringRelease(js_string); js_string = NULL;
 
-	return Local<String>(v8_string);
+	return Local<String>(V8LIKE_MOVE(v8_string));
 }
 
 /*static*/ Local<String> String::New(const uint16_t* data, int length)
@@ -1323,24 +2512,43 @@ bool String::CanMakeExternal()
 
 	JSStringRelease(js_string); js_string = NULL;
 
-	return Local<String>(v8_string);
+	return Local<String>(V8LIKE_MOVE(v8_string));
 }
 
 /*static*/ Local<String> String::NewSymbol(const char* data, int length)
 {
+	String* symbol = (data != NULL)?(Context::GetCurrentCache()->GetSymbol(data, length)):(NULL);
+	if (symbol != NULL)
+	{
+		return Local<String>(symbol);
+	}
 	return String::New(data, length);
 }
 
 /*static*/ Local<String> String::Concat(Handle<String> left, Handle<String> right)
 {
-	JSValueRef js_exception = NULL;
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
 
-	JSStringRef js_string_l = JSValueToStringCopy(js_ctx, left->m_js_value, &js_exception);
+	const int length = left->_GetLength() + right->_GetLength();
+	if (left->_GetLength() == 0)
+	{
+		return Local<String>(right);
+	}
+	if (right->_GetLength() == 0)
+	{
+		return Local<String>(left);
+	}
+	if (length >= kRopeMinLength)
+	{
+		// O(1) now, one copy when flattened
+		return Local<String>(new String(js_ctx, left, right));
+	}
+
+	JSStringRef js_string_l = left->_GetJSString();
 	const size_t js_length_l = JSStringGetLength(js_string_l);
 	const JSChar* js_data_l = JSStringGetCharactersPtr(js_string_l);
 
-	JSStringRef js_string_r = JSValueToStringCopy(js_ctx, right->m_js_value, &js_exception);
+	JSStringRef js_string_r = right->_GetJSString();
 	const size_t js_length_r = JSStringGetLength(js_string_r);
 	const JSChar* js_data_r = JSStringGetCharactersPtr(js_string_r);
 
@@ -1360,8 +2568,8 @@ bool String::CanMakeExternal()
 		js_data[js_index] = js_data_r[js_index_r];
 	}
 
-	JSStringRelease(js_string_l); js_string_l = NULL; js_data_l = NULL;
-	JSStringRelease(js_string_r); js_string_r = NULL; js_data_r = NULL;
+	js_string_l = NULL; js_data_l = NULL;
+	js_string_r = NULL; js_data_r = NULL;
 
 	JSStringRef js_string = JSStringCreateWithCharacters(js_data, js_length);
 	assert(JSStringGetCharactersPtr(js_string) != js_data);
@@ -1373,7 +2581,7 @@ bool String::CanMakeExternal()
 
 	JSStringRelease(js_string); js_string = NULL;
 
-	return Local<String>(v8_string);
+	return Local<String>(V8LIKE_MOVE(v8_string));
 }
 
 /*static*/ Local<String> String::NewExternal(String::ExternalStringResource* resource)
@@ -1385,19 +2593,20 @@ bool String::CanMakeExternal()
 
 	if (data)
 	{
+		// the C API has no way to borrow the buffer, so JSC gets its one copy here
 		js_string = JSStringCreateWithCharacters((const JSChar*) data, (size_t) length);
 		assert(JSStringGetCharactersPtr(js_string) != (const JSChar*) data);
 		assert(JSStringGetLength(js_string) == (size_t) length);
 	}
 
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	Handle<String> v8_string(new String(js_ctx, JSValueMakeString(js_ctx, js_string)));
-
-	JSStringRelease(js_string); js_string = NULL;
+	String* string = new String(js_ctx, JSValueMakeString(js_ctx, js_string));
+	string->m_js_string = js_string; // kept, released by ~String
 
-	delete resource;
+	// JSC holds its own copy now; the resource is not needed past this point
+	resource->Dispose();
 
-	return Local<String>(v8_string);
+	return Local<String>(string);
 }
 
 /*static*/ Local<String> String::NewExternal(String::ExternalAsciiStringResource* resource)
@@ -1409,29 +2618,16 @@ bool String::CanMakeExternal()
 
 	if (data)
 	{
-		JSChar* buffer = new JSChar[length];
-		assert(buffer);
-
-		for (int i = 0; i < length; ++i)
-		{
-			buffer[i] = data[i];
-		}
-
-		js_string = JSStringCreateWithCharacters(buffer, (size_t) length);
-		assert(JSStringGetCharactersPtr(js_string) != buffer);
-		assert(JSStringGetLength(js_string) == (size_t) length);
-
-		delete[] buffer; buffer = NULL;
+		js_string = JSStringCreateWithLatin1(data, length);
 	}
 
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	Handle<String> v8_string(new String(js_ctx, JSValueMakeString(js_ctx, js_string)));
+	String* string = new String(js_ctx, JSValueMakeString(js_ctx, js_string));
+	string->m_js_string = js_string; // kept, released by ~String
 
-	JSStringRelease(js_string); js_string = NULL;
-
-	delete resource;
+	resource->Dispose();
 
-	return Local<String>(v8_string);
+	return Local<String>(string);
 }
 
 /*static*/ Local<String> String::NewUndetectable(const char* data, int length)
@@ -1474,22 +2670,64 @@ Local<Value> AccessorInfo::Data() const
 	return Local<Value>(m_data);
 }
 
-/// v8::internal::StringCompare
+/// v8::internal::PropertyName
 
-bool internal::StringCompare::operator()(const Handle<String>& key1, const Handle<String>& key2) const
+internal::PropertyName::PropertyName(JSContextRef js_ctx, JSStringRef js_string) :
+	m_js_ctx(js_ctx), m_js_string(js_string), m_hash(0), m_is_hashed(false)
 {
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	JSStringRef js_key1 = JSValueToStringCopy(js_ctx, key1->m_js_value, NULL);
-	JSStringRef js_key2 = JSValueToStringCopy(js_ctx, key2->m_js_value, NULL);
-	int ret = JSStringCompare(js_key1, js_key2);
-	JSStringRelease(js_key1);
-	JSStringRelease(js_key2);
-	return ret < 0;
+}
+
+internal::PropertyName::PropertyName(Handle<String> string) :
+	m_js_ctx(NULL), m_js_string(string->_GetJSString()), m_hash(0), m_is_hashed(false), m_string(string)
+{
+}
+
+uint32_t internal::PropertyName::_GetHash() const
+{
+	if (!m_string.IsEmpty())
+	{
+		return m_string->_GetHash(); // cached on the wrapper, and free for symbols
+	}
+	if (!m_is_hashed)
+	{
+		m_hash = JSCharHash(JSStringGetCharactersPtr(m_js_string), JSStringGetLength(m_js_string));
+		m_is_hashed = true;
+	}
+	return m_hash;
+}
+
+bool internal::PropertyName::_ContentEquals(const String* other) const
+{
+	if (*m_string == other)
+	{
+		return true;
+	}
+	const size_t length = JSStringGetLength(m_js_string);
+	if ((length != (size_t) other->_GetLength()) || (_GetHash() != other->_GetHash()))
+	{
+		return false;
+	}
+	return (memcmp(JSStringGetCharactersPtr(m_js_string), JSStringGetCharactersPtr(other->_GetJSString()), length * sizeof(JSChar)) == 0);
+}
+
+bool internal::PropertyName::_AsArrayIndex(uint32_t* index) const
+{
+	return JSCharParseArrayIndex(JSStringGetCharactersPtr(m_js_string), JSStringGetLength(m_js_string), index);
+}
+
+Handle<String> internal::PropertyName::GetString() const
+{
+	if (m_string.IsEmpty())
+	{
+		m_string = Handle<String>(new String(m_js_ctx, m_js_string));
+	}
+	return m_string;
 }
 
 /// v8::internal::Helper
 
 internal::Helper::Helper() :
+	m_js_class(NULL),
 	m_internal_field_array(NULL), m_internal_field_count(0),
 	m_pixel_data(NULL), m_pixel_data_length(0),
 	m_external_array_data(NULL), m_external_array_data_type((ExternalArrayType) 0), m_external_array_data_length(0)
@@ -1500,45 +2738,374 @@ internal::Helper::~Helper()
 {
 	if (m_internal_field_array != NULL)
 	{
-		delete[] m_internal_field_array; m_internal_field_array = NULL;
+		delete[] m_internal_field_array; m_internal_field_array = NULL;
+	}
+	m_internal_field_count = 0;
+
+	if (m_pixel_data != NULL)
+	{
+		m_pixel_data = NULL;
+	}
+	m_pixel_data_length = 0;
+
+	if (m_external_array_data != NULL)
+	{
+		m_external_array_data = NULL;
+	}
+	m_external_array_data_type = (ExternalArrayType) 0;
+	m_external_array_data_length = 0;
+}
+
+void internal::Helper::SetInternalFieldCount(int internal_field_count)
+{
+	if (m_internal_field_count != internal_field_count)
+	{
+		if (m_internal_field_array != NULL)
+		{
+			delete[] m_internal_field_array; m_internal_field_array = NULL;
+		}
+
+		m_internal_field_count = internal_field_count;
+
+		if (m_internal_field_count > 0)
+		{
+			m_internal_field_array = new internal::Helper::InternalField[m_internal_field_count];
+		}
+	}
+}
+
+bool internal::Helper::NeedsInterception() const
+{
+	// an instance created with its template's current class gets its accessors from the class's
+	// static values; only state of its own still needs the callbacks
+	if (m_accessor_map.empty() && (m_external_array_data == NULL) && m_function.IsEmpty() &&
+		!m_object_template.IsEmpty() && m_object_template->_IsCurrentJSClass(m_js_class))
+	{
+		return false;
+	}
+	return true;
+}
+
+/*static*/ void internal::Helper::WeakFree(Persistent<Value> object, void* parameter)
+{
+	delete static_cast<internal::Helper*>(parameter);
+}
+
+/// v8::internal::ContextCache
+
+static JSStringRef const* sg_js_builtin_name_array[] =
+{
+	#define V8LIKE_BUILTIN_NAME(name) &sg_js_name_##name,
+	V8LIKE_BUILTIN_LIST(V8LIKE_BUILTIN_NAME)
+	#undef V8LIKE_BUILTIN_NAME
+};
+
+internal::ContextCache::ContextCache(JSContextRef js_ctx) :
+	m_js_ctx(js_ctx),
+	m_js_global_object(JSContextGetGlobalObject(js_ctx)),
+	m_js_object_to_string(NULL),
+	m_js_array_is_array(NULL),
+	m_js_date_get_time(NULL),
+	m_undefined_value(new Primitive(js_ctx, JSValueMakeUndefined(js_ctx))),
+	m_null_value(new Primitive(js_ctx, JSValueMakeNull(js_ctx))),
+	m_true_value(new Boolean(js_ctx, JSValueMakeBoolean(js_ctx, true))),
+	m_false_value(new Boolean(js_ctx, JSValueMakeBoolean(js_ctx, false))),
+	m_symbol_array(64), m_symbol_count(0)
+{
+	m_undefined_value->SetImmediate(Value::kImmediateUndefined);
+	m_null_value->SetImmediate(Value::kImmediateNull);
+	m_true_value->SetImmediate(Value::kImmediateBoolean, 1.0);
+	m_false_value->SetImmediate(Value::kImmediateBoolean, 0.0);
+
+	m_undefined_value->MakeImmortal();
+	m_null_value->MakeImmortal();
+	m_true_value->MakeImmortal();
+	m_false_value->MakeImmortal();
+
+	for (int index = 0; index < kSmallIntegerCount; ++index)
+	{
+		m_small_integer_array[index] = NULL;
+	}
+
+	for (int builtin = 0; builtin < kBuiltinCount; ++builtin)
+	{
+		m_js_builtin_array[builtin] = NULL;
+	}
+}
+
+internal::ContextCache::~ContextCache()
+{
+	delete m_undefined_value; m_undefined_value = NULL;
+	delete m_null_value; m_null_value = NULL;
+	delete m_true_value; m_true_value = NULL;
+	delete m_false_value; m_false_value = NULL;
+
+	for (int index = 0; index < kSmallIntegerCount; ++index)
+	{
+		delete m_small_integer_array[index]; m_small_integer_array[index] = NULL;
+	}
+
+	if (m_js_object_to_string != NULL)
+	{
+		for (int builtin = 0; builtin < kBuiltinCount; ++builtin)
+		{
+			JSValueUnprotect(m_js_ctx, m_js_builtin_array[builtin]); m_js_builtin_array[builtin] = NULL;
+		}
+		JSValueUnprotect(m_js_ctx, m_js_object_to_string); m_js_object_to_string = NULL;
+		JSValueUnprotect(m_js_ctx, m_js_array_is_array); m_js_array_is_array = NULL;
+		JSValueUnprotect(m_js_ctx, m_js_date_get_time); m_js_date_get_time = NULL;
+	}
+
+	// symbols still held by templates or handles outlive the table
+	for (size_t index = 0; index < m_symbol_array.size(); ++index)
+	{
+		if (m_symbol_array[index].m_string != NULL)
+		{
+			m_symbol_array[index].m_string->DecRef(); m_symbol_array[index].m_string = NULL;
+		}
+	}
+
+	// wrappers outliving the context must not evict from a dead map
+	for (size_t index = 0; index < m_object_map.GetCapacity(); ++index)
+	{
+		Object* object = m_object_map.GetValueAt(index);
+		if (object != NULL)
+		{
+			object->m_identity_cache = NULL;
+		}
+	}
+}
+
+void internal::ContextCache::FetchJSBuiltins()
+{
+	// not in the constructor: the global object has no wrapper yet to answer property requests
+	for (int builtin = 0; builtin < kBuiltinCount; ++builtin)
+	{
+		JSValueRef js_value = JSObjectGetProperty(m_js_ctx, m_js_global_object, *sg_js_builtin_name_array[builtin], NULL);
+		m_js_builtin_array[builtin] = JSValueToObject(m_js_ctx, js_value, NULL);
+		JSValueProtect(m_js_ctx, m_js_builtin_array[builtin]);
+	}
+	m_js_array_is_array = JSValueToObject(m_js_ctx, JSObjectGetProperty(m_js_ctx, m_js_builtin_array[kBuiltinArray], sg_js_name_isArray, NULL), NULL);
+	JSValueProtect(m_js_ctx, m_js_array_is_array);
+	JSObjectRef js_prototype = JSValueToObject(m_js_ctx, JSObjectGetProperty(m_js_ctx, m_js_builtin_array[kBuiltinDate], sg_js_name_prototype, NULL), NULL);
+	m_js_date_get_time = JSValueToObject(m_js_ctx, JSObjectGetProperty(m_js_ctx, js_prototype, sg_js_name_getTime, NULL), NULL);
+	JSValueProtect(m_js_ctx, m_js_date_get_time);
+	// set last: GetJSBuiltin and friends test it to know the fetch is done
+	js_prototype = JSValueToObject(m_js_ctx, JSObjectGetProperty(m_js_ctx, m_js_builtin_array[kBuiltinObject], sg_js_name_prototype, NULL), NULL);
+	m_js_object_to_string = JSValueToObject(m_js_ctx, JSObjectGetProperty(m_js_ctx, js_prototype, sg_js_name_toString, NULL), NULL);
+	JSValueProtect(m_js_ctx, m_js_object_to_string);
+}
+
+JSObjectRef internal::ContextCache::GetJSBuiltin(JSContextRef js_ctx, Builtin builtin)
+{
+	if (JSContextGetGlobalObject(js_ctx) == m_js_global_object)
+	{
+		if (m_js_object_to_string == NULL)
+		{
+			FetchJSBuiltins();
+		}
+		return m_js_builtin_array[builtin];
+	}
+
+	// js_ctx belongs to another global context; use its own constructor
+	JSObjectRef js_global_object = JSContextGetGlobalObject(js_ctx);
+	return JSValueToObject(js_ctx, JSObjectGetProperty(js_ctx, js_global_object, *sg_js_builtin_name_array[builtin], NULL), NULL);
+}
+
+JSObjectRef internal::ContextCache::GetJSObjectToString(JSContextRef js_ctx)
+{
+	if (JSContextGetGlobalObject(js_ctx) == m_js_global_object)
+	{
+		if (m_js_object_to_string == NULL)
+		{
+			FetchJSBuiltins();
+		}
+		return m_js_object_to_string;
+	}
+
+	JSObjectRef js_ctor = GetJSBuiltin(js_ctx, kBuiltinObject);
+	JSObjectRef js_prototype = JSValueToObject(js_ctx, JSObjectGetProperty(js_ctx, js_ctor, sg_js_name_prototype, NULL), NULL);
+	return JSValueToObject(js_ctx, JSObjectGetProperty(js_ctx, js_prototype, sg_js_name_toString, NULL), NULL);
+}
+
+JSObjectRef internal::ContextCache::GetJSArrayIsArray(JSContextRef js_ctx)
+{
+	if (JSContextGetGlobalObject(js_ctx) == m_js_global_object)
+	{
+		if (m_js_object_to_string == NULL)
+		{
+			FetchJSBuiltins();
+		}
+		return m_js_array_is_array;
+	}
+
+	JSObjectRef js_ctor = GetJSBuiltin(js_ctx, kBuiltinArray);
+	return JSValueToObject(js_ctx, JSObjectGetProperty(js_ctx, js_ctor, sg_js_name_isArray, NULL), NULL);
+}
+
+JSObjectRef internal::ContextCache::GetJSDateGetTime(JSContextRef js_ctx)
+{
+	if (JSContextGetGlobalObject(js_ctx) == m_js_global_object)
+	{
+		if (m_js_object_to_string == NULL)
+		{
+			FetchJSBuiltins();
+		}
+		return m_js_date_get_time;
+	}
+
+	JSObjectRef js_ctor = GetJSBuiltin(js_ctx, kBuiltinDate);
+	JSObjectRef js_prototype = JSValueToObject(js_ctx, JSObjectGetProperty(js_ctx, js_ctor, sg_js_name_prototype, NULL), NULL);
+	return JSValueToObject(js_ctx, JSObjectGetProperty(js_ctx, js_prototype, sg_js_name_getTime, NULL), NULL);
+}
+
+Integer* internal::ContextCache::GetSmallInteger(double value)
+{
+	// -0 is not an integer to JS, so it always gets a wrapper of its own
+	if ((kSmallIntegerMin <= value) && (value <= kSmallIntegerMax) && (value == std::floor(value)) && !((value == 0.0) && std::signbit(value)))
+	{
+		Integer*& integer = m_small_integer_array[(int) value - kSmallIntegerMin];
+		if (integer == NULL)
+		{
+			integer = new Integer(m_js_ctx, JSValueMakeNumber(m_js_ctx, value));
+			integer->SetImmediate(Value::kImmediateNumber, value);
+			integer->MakeImmortal();
+			++m_stats.m_small_integer_miss_count;
+		}
+		else
+		{
+			++m_stats.m_small_integer_hit_count;
+		}
+		return integer;
+	}
+	++m_stats.m_small_integer_miss_count;
+	return NULL;
+}
+
+Object* internal::ContextCache::FindObject(JSObjectRef js_object)
+{
+	Object* object = m_object_map.Find(js_object);
+	if ((object != NULL) && !object->m_js_is_protected)
+	{
+		// unprotected (or only weakly held), so JSC may have collected it and reused the address
+		RemoveObject(object);
+		object = NULL;
+	}
+
+	if (object != NULL)
+	{
+		++m_stats.m_object_hit_count;
+	}
+	else
+	{
+		++m_stats.m_object_miss_count;
+	}
+	return object;
+}
+
+void internal::ContextCache::AddObject(Object* object)
+{
+	assert(!object->m_is_native);
+	assert(object->m_identity_cache == NULL);
+	m_object_map.Insert(object->m_js_object, object);
+	object->m_identity_cache = this;
+}
+
+void internal::ContextCache::RemoveObject(Object* object)
+{
+	assert(object->m_identity_cache == this);
+	m_object_map.Remove(object->m_js_object);
+	object->m_identity_cache = NULL;
+}
+
+String* internal::ContextCache::GetSymbol(const char* data, int length)
+{
+	// FNV-1a over the bytes; only ASCII is interned, where each byte is one code unit
+	const size_t size = (length < 0)?(strlen(data)):((size_t) length);
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < size; ++i)
+	{
+		const unsigned char ch = (unsigned char) data[i];
+		if (ch >= 0x80)
+		{
+			++m_stats.m_symbol_miss_count;
+			return NULL;
+		}
+		hash = (hash ^ ch) * 16777619u;
 	}
-	m_internal_field_count = 0;
 
-	if (m_pixel_data != NULL)
+	const size_t mask = m_symbol_array.size() - 1;
+	size_t index = hash & mask;
+	for ( ; m_symbol_array[index].m_string != NULL; index = (index + 1) & mask)
 	{
-		m_pixel_data = NULL;
+		const Symbol& symbol = m_symbol_array[index];
+		if ((symbol.m_hash == hash) && (JSStringGetLength(symbol.m_string->m_js_string) == size))
+		{
+			const JSChar* js_data = JSStringGetCharactersPtr(symbol.m_string->m_js_string);
+			size_t i = 0;
+			while ((i < size) && (js_data[i] == (JSChar) data[i]))
+			{
+				++i;
+			}
+			if (i == size)
+			{
+				++m_stats.m_symbol_hit_count;
+				return symbol.m_string;
+			}
+		}
 	}
-	m_pixel_data_length = 0;
 
-	if (m_external_array_data != NULL)
+	JSStringRef js_string = JSStringCreateWithLatin1(data, size);
+	String* string = new String(m_js_ctx, JSValueMakeString(m_js_ctx, js_string));
+	string->m_js_string = js_string; // the table's copy, released by ~String
+	string->m_is_symbol = true;
+	string->m_hash = hash; // the same FNV-1a as _GetHash, since every unit is below 0x80
+	string->m_is_hashed = true;
+	string->IncRef(); // held by the table until the context goes away
+	++m_stats.m_symbol_miss_count;
+
+	m_symbol_array[index].m_hash = hash;
+	m_symbol_array[index].m_string = string;
+	if ((++m_symbol_count * 4) > (m_symbol_array.size() * 3))
 	{
-		m_external_array_data = NULL;
+		GrowSymbols();
 	}
-	m_external_array_data_type = (ExternalArrayType) 0;
-	m_external_array_data_length = 0;
+	return string;
 }
 
-void internal::Helper::SetInternalFieldCount(int internal_field_count)
+void internal::ContextCache::GrowSymbols()
 {
-	if (m_internal_field_count != internal_field_count)
+	std::vector<Symbol> symbol_array(m_symbol_array.size() * 2);
+	symbol_array.swap(m_symbol_array);
+	const size_t mask = m_symbol_array.size() - 1;
+	for (size_t i = 0; i < symbol_array.size(); ++i)
 	{
-		if (m_internal_field_array != NULL)
-		{
-			delete[] m_internal_field_array; m_internal_field_array = NULL;
-		}
-
-		m_internal_field_count = internal_field_count;
-
-		if (m_internal_field_count > 0)
+		if (symbol_array[i].m_string != NULL)
 		{
-			m_internal_field_array = new internal::Helper::InternalField[m_internal_field_count];
+			size_t index = symbol_array[i].m_hash & mask;
+			while (m_symbol_array[index].m_string != NULL)
+			{
+				index = (index + 1) & mask;
+			}
+			m_symbol_array[index] = symbol_array[i];
 		}
 	}
 }
 
-/*static*/ void internal::Helper::WeakFree(Persistent<Value> object, void* parameter)
+void internal::ContextCache::PrintStats(FILE* out) const
 {
-	delete static_cast<internal::Helper*>(parameter);
+	size_t total_count = m_stats.m_small_integer_hit_count + m_stats.m_small_integer_miss_count;
+	fprintf(out, "small integer cache [%d, %d]: %lu hits, %lu misses (%.1f%% hit rate)\n", kSmallIntegerMin, kSmallIntegerMax,
+		(unsigned long) m_stats.m_small_integer_hit_count, (unsigned long) m_stats.m_small_integer_miss_count,
+		(total_count > 0)?(100.0 * m_stats.m_small_integer_hit_count / total_count):(0.0));
+	total_count = m_stats.m_object_hit_count + m_stats.m_object_miss_count;
+	fprintf(out, "object identity cache: %lu hits, %lu misses (%.1f%% hit rate), %lu live\n",
+		(unsigned long) m_stats.m_object_hit_count, (unsigned long) m_stats.m_object_miss_count,
+		(total_count > 0)?(100.0 * m_stats.m_object_hit_count / total_count):(0.0), (unsigned long) m_object_map.GetCount());
+	total_count = m_stats.m_symbol_hit_count + m_stats.m_symbol_miss_count;
+	fprintf(out, "symbol table: %lu hits, %lu misses (%.1f%% hit rate), %lu interned\n",
+		(unsigned long) m_stats.m_symbol_hit_count, (unsigned long) m_stats.m_symbol_miss_count,
+		(total_count > 0)?(100.0 * m_stats.m_symbol_hit_count / total_count):(0.0), (unsigned long) m_symbol_count);
 }
 
 /// v8::Object
@@ -1546,14 +3113,14 @@ void internal::Helper::SetInternalFieldCount(int internal_field_count)
 RTTI_IMPLEMENT(v8::Object, v8::Primitive);
 
 Object::Object() :
-	m_js_object(NULL), m_is_native(false), m_helper(NULL)
+	m_js_object(NULL), m_is_native(false), m_helper(NULL), m_identity_cache(NULL)
 {
 }
 
-Object::Object(JSContextRef js_ctx) :
-	m_js_object(NULL), m_is_native(false), m_helper(NULL)
+Object::Object(JSContextRef js_ctx, JSClassRef js_class) :
+	m_js_object(NULL), m_is_native(false), m_helper(NULL), m_identity_cache(NULL)
 {
-	Object::AttachJSContextAndJSObject(js_ctx, JSObjectMake(js_ctx, Object::GetJSClass(), this));
+	Object::AttachJSContextAndJSObject(js_ctx, JSObjectMake(js_ctx, (js_class)?(js_class):(Object::GetJSClass()), this));
 	assert(JSValueIsObjectOfClass(js_ctx, m_js_value, Object::GetJSClass()));
 	assert(JSObjectGetPrivate(m_js_object) == this);
 
@@ -1562,18 +3129,16 @@ Object::Object(JSContextRef js_ctx) :
 	//JSObjectSetPrototype(js_ctx, m_js_object, js_prototype);
 
 	// m_js_object.__proto__ = new Object();
-	JSStringRef js_name = JSStringCreateWithUTF8CString("Object");
-	JSObjectRef js_ctor = JSValueToObject(js_ctx, JSObjectGetProperty(js_ctx, Context::GetJSGlobalObject(js_ctx, JSContextGetGlobalObject(js_ctx)), js_name, NULL), NULL);
+	JSObjectRef js_ctor = Context::GetCurrentCache()->GetJSBuiltin(js_ctx, internal::ContextCache::kBuiltinObject);
 	JSObjectRef js_prototype = JSObjectCallAsConstructor(js_ctx, js_ctor, 0, NULL, NULL);
 	JSObjectSetPrototype(js_ctx, m_js_object, js_prototype);
-	JSStringRelease(js_name); js_name = NULL;
 
 	assert(JSObjectGetPrivate(m_js_object) == this);
 	assert(JSValueIsObject(js_ctx, m_js_value));
 }
 
 Object::Object(JSContextRef js_ctx, JSObjectRef js_object) :
-	m_js_object(NULL), m_is_native(false), m_helper(NULL)
+	m_js_object(NULL), m_is_native(false), m_helper(NULL), m_identity_cache(NULL)
 {
 	Object::AttachJSContextAndJSObject(js_ctx, js_object);
 	//assert(JSObjectGetPrivate(m_js_object) == NULL);
@@ -1600,6 +3165,11 @@ Object::~Object()
 	}
 	else
 	{
+		if (m_identity_cache != NULL)
+		{
+			m_identity_cache->RemoveObject(this);
+		}
+
 		if (m_helper != NULL)
 		{
 			// owned by v8::External
@@ -1679,7 +3249,7 @@ internal::Helper* Object::GetHelper()
 		{
 			JSValueRef js_exception = NULL;
 			JSContextRef js_ctx = Context::GetCurrentJSContext();
-			internal::JSStringWrap js_name("__helper__");
+			JSStringRef js_name = sg_js_name___helper__;
 			if (!JSObjectHasProperty(js_ctx, m_js_object, js_name))
 			{
 				internal::Helper* helper = new internal::Helper();
@@ -1700,7 +3270,7 @@ internal::Helper* Object::GetHelper()
 	}
 }
 
-bool Object::_ObjectHasProperty(Handle<String> name)
+bool Object::_ObjectHasProperty(const internal::PropertyName& name)
 {
 	internal::Helper* helper = GetHelper();
 
@@ -1735,7 +3305,7 @@ bool Object::_ObjectHasProperty(Handle<String> name)
 	return false;
 }
 
-Handle<Value> Object::_ObjectGetProperty(Handle<String> name)
+Handle<Value> Object::_ObjectGetProperty(const internal::PropertyName& name)
 {
 	Handle<Value> value;
 
@@ -1746,7 +3316,7 @@ Handle<Value> Object::_ObjectGetProperty(Handle<String> name)
 	if (accessor_it != helper->m_accessor_map.end())
 	{
 		AccessorInfo accessor_info(Isolate::GetCurrent(), Handle<Object>(this), Handle<Object>(this), accessor_it->second.m_data); // TODO: holder?
-		return accessor_it->second.m_getter(Local<String>(name), accessor_info);
+		return accessor_it->second.m_getter(Local<String>(accessor_it->first), accessor_info);
 	}
 
 	// check object template, for Objects created by ObjectTemplate::NewInstance()
@@ -1781,7 +3351,7 @@ Handle<Value> Object::_ObjectGetProperty(Handle<String> name)
 	return value;
 }
 
-bool Object::_ObjectSetProperty(Handle<String> name, Handle<Value> value, PropertyAttribute attrib)
+bool Object::_ObjectSetProperty(const internal::PropertyName& name, Handle<Value> value, PropertyAttribute attrib)
 {
 	internal::Helper* helper = GetHelper();
 
@@ -1790,7 +3360,7 @@ bool Object::_ObjectSetProperty(Handle<String> name, Handle<Value> value, Proper
 	if (accessor_it != helper->m_accessor_map.end())
 	{
 		AccessorInfo accessor_info(Isolate::GetCurrent(), Handle<Object>(this), Handle<Object>(this), accessor_it->second.m_data); // TODO: holder?
-		accessor_it->second.m_setter(Local<String>(name), Local<Value>(value), accessor_info);
+		accessor_it->second.m_setter(Local<String>(accessor_it->first), Local<Value>(value), accessor_info);
 		return true;
 	}
 
@@ -1816,7 +3386,7 @@ bool Object::_ObjectSetProperty(Handle<String> name, Handle<Value> value, Proper
 	}
 	else
 	{
-		helper->m_property_map[name] = internal::Property(value, attrib);
+		helper->m_property_map[name.GetString()] = internal::Property(value, attrib);
 	}
 	return true;
 	#endif
@@ -1824,7 +3394,7 @@ bool Object::_ObjectSetProperty(Handle<String> name, Handle<Value> value, Proper
 	return false;
 }
 
-bool Object::_ObjectDeleteProperty(Handle<String> name)
+bool Object::_ObjectDeleteProperty(const internal::PropertyName& name)
 {
 	internal::Helper* helper = GetHelper();
 
@@ -1872,7 +3442,7 @@ void Object::_ObjectGetPropertyNames(JSPropertyNameAccumulatorRef js_name_accumu
 	{
 		if (!(accessor_it->second.m_attrib & DontEnum))
 		{
-			JSStringRef js_name = JSValueToStringCopy(js_ctx, accessor_it->first->m_js_value, NULL);
+			JSStringRef js_name = JSValueToStringCopy(js_ctx, accessor_it->first->GetJSValue(), NULL);
 			JSPropertyNameAccumulatorAddName(js_name_accumulator, js_name);
 			JSStringRelease(js_name);
 		}
@@ -1896,7 +3466,7 @@ void Object::_ObjectGetPropertyNames(JSPropertyNameAccumulatorRef js_name_accumu
 	{
 		if (!(property_it->second.m_attrib & DontEnum))
 		{
-			JSStringRef js_name = JSValueToStringCopy(js_ctx, property_it->first->m_js_value, NULL);
+			JSStringRef js_name = JSValueToStringCopy(js_ctx, property_it->first->GetJSValue(), NULL);
 			JSPropertyNameAccumulatorAddName(js_name_accumulator, js_name);
 			JSStringRelease(js_name);
 		}
@@ -1910,7 +3480,7 @@ bool Object::Has(Handle<String> key)
 	{
 		JSValueRef js_exception = NULL;
 		JSContextRef js_ctx = Context::GetCurrentJSContext();
-		JSStringRef js_name = JSValueToStringCopy(js_ctx, key->m_js_value, &js_exception);
+		JSStringRef js_name = JSValueToStringCopy(js_ctx, key->GetJSValue(), &js_exception);
 		bool has = JSObjectHasProperty(js_ctx, m_js_object, js_name);
 		JSStringRelease(js_name); js_name = NULL;
 		return has;
@@ -1927,7 +3497,7 @@ Local<Value> Object::Get(Handle<Value> key)
 	{
 		JSValueRef js_exception = NULL;
 		JSContextRef js_ctx = Context::GetCurrentJSContext();
-		JSStringRef js_name = JSValueToStringCopy(js_ctx, key->m_js_value, &js_exception);
+		JSStringRef js_name = JSValueToStringCopy(js_ctx, key->GetJSValue(), &js_exception);
 		JSValueRef js_value = JSObjectGetProperty(js_ctx, m_js_object, js_name, &js_exception);
 		JSStringRelease(js_name); js_name = NULL;
 		return Local<Value>(internal::ImportValue(js_ctx, js_value));
@@ -1944,7 +3514,7 @@ bool Object::Set(Handle<Value> key, Handle<Value> value, PropertyAttribute attri
 	{
 		JSValueRef js_exception = NULL;
 		JSContextRef js_ctx = Context::GetCurrentJSContext();
-		JSStringRef js_name = JSValueToStringCopy(js_ctx, key->m_js_value, &js_exception);
+		JSStringRef js_name = JSValueToStringCopy(js_ctx, key->GetJSValue(), &js_exception);
 		JSValueRef js_value = internal::ExportValue(value);
 		JSPropertyAttributes js_attrib = kJSPropertyAttributeNone;
 		if (attrib & ReadOnly)   { js_attrib |= kJSPropertyAttributeReadOnly; }
@@ -1975,7 +3545,7 @@ bool Object::Delete(Handle<String> key)
 	{
 		JSValueRef js_exception = NULL;
 		JSContextRef js_ctx = Context::GetCurrentJSContext();
-		JSStringRef js_name = JSValueToStringCopy(js_ctx, key->m_js_value, &js_exception);
+		JSStringRef js_name = JSValueToStringCopy(js_ctx, key->GetJSValue(), &js_exception);
 		bool deleted = JSObjectDeleteProperty(js_ctx, m_js_object, js_name, &js_exception);
 		JSStringRelease(js_name); js_name = NULL;
 		return deleted;
@@ -1995,15 +3565,15 @@ PropertyAttribute Object::GetPropertyAttributes(Handle<Value> key)
 {
 	JSValueRef js_exception = NULL;
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	JSObjectRef js_ctor = JSValueToObject(js_ctx, JSObjectGetProperty(js_ctx, Context::GetJSGlobalObject(js_ctx, JSContextGetGlobalObject(js_ctx)), internal::JSStringWrap("Object"), &js_exception), &js_exception);
-	JSObjectRef js_func = JSValueToObject(js_ctx, JSObjectGetProperty(js_ctx, js_ctor, internal::JSStringWrap("getOwnPropertyDescriptor"), &js_exception), &js_exception);
+	JSObjectRef js_ctor = Context::GetCurrentCache()->GetJSBuiltin(js_ctx, internal::ContextCache::kBuiltinObject);
+	JSObjectRef js_func = JSValueToObject(js_ctx, JSObjectGetProperty(js_ctx, js_ctor, sg_js_name_getOwnPropertyDescriptor, &js_exception), &js_exception);
 	JSObjectRef js_that = NULL;
-	const JSValueRef js_argv[] = { m_js_object, key->m_js_value };
+	const JSValueRef js_argv[] = { m_js_object, key->GetJSValue() };
 	size_t js_argc = sizeof(js_argv) / sizeof(*js_argv);
 	JSObjectRef js_desc = JSValueToObject(js_ctx, JSObjectCallAsFunction(js_ctx, js_func, js_that, js_argc, js_argv, &js_exception), &js_exception);
-	JSValueRef js_writable     = JSObjectGetProperty(js_ctx, js_desc, internal::JSStringWrap("writable"    ), &js_exception);
-	JSValueRef js_enumerable   = JSObjectGetProperty(js_ctx, js_desc, internal::JSStringWrap("enumberable" ), &js_exception);
-	JSValueRef js_configurable = JSObjectGetProperty(js_ctx, js_desc, internal::JSStringWrap("configurable"), &js_exception);
+	JSValueRef js_writable     = JSObjectGetProperty(js_ctx, js_desc, sg_js_name_writable, &js_exception);
+	JSValueRef js_enumerable   = JSObjectGetProperty(js_ctx, js_desc, sg_js_name_enumerable, &js_exception);
+	JSValueRef js_configurable = JSObjectGetProperty(js_ctx, js_desc, sg_js_name_configurable, &js_exception);
 	int prop = None;
 	if (JSValueIsBoolean(js_ctx, js_writable) && !JSValueToBoolean(js_ctx, js_writable))
 	{
@@ -2155,11 +3725,48 @@ bool Object::Delete(uint32_t index)
 
 bool Object::SetAccessor(Handle<String> name, AccessorGetter getter, AccessorSetter setter, Handle<Value> data, AccessControl settings, PropertyAttribute attrib)
 {
+	internal::Accessor accessor(getter, setter, data, settings, attrib);
+
+	#if V8LIKE_NATIVE_ACCESSORS
+	// install as a real getter/setter property, which leaves the interception callbacks with nothing
+	// to do for this object; a name a template accessor answers stays in the map, since the static
+	// value of the template's class would be found before the property
+	if (m_js_object && (!m_is_native || GetHelper()->m_object_template.IsEmpty() ||
+		(GetHelper()->m_object_template->_ObjectTemplateResolveGetter(name).m_kind != internal::TemplateLookup::kKindAccessor)))
+	{
+		return _ObjectDefineAccessor(name, accessor);
+	}
+	#endif
+
 	internal::Helper* helper = GetHelper();
-	helper->m_accessor_map[name] = internal::Accessor(getter, setter, data, settings, attrib);
+	helper->m_accessor_map[name] = accessor;
 	return true;
 }
 
+bool Object::_ObjectDefineAccessor(Handle<String> name, const internal::Accessor& accessor)
+{
+	JSValueRef js_exception = NULL;
+	JSContextRef js_ctx = Context::GetCurrentJSContext();
+	JSObjectRef js_desc = JSObjectMake(js_ctx, NULL, NULL);
+	JSObjectRef js_getter = JSObjectMake(js_ctx, Object::_GetJSAccessorClass(), new internal::AccessorFunction(name, accessor, false));
+	JSObjectSetProperty(js_ctx, js_desc, sg_js_name_get, js_getter, kJSPropertyAttributeNone, &js_exception);
+	if ((accessor.m_setter != NULL) && !(accessor.m_attrib & ReadOnly))
+	{
+		JSObjectRef js_setter = JSObjectMake(js_ctx, Object::_GetJSAccessorClass(), new internal::AccessorFunction(name, accessor, true));
+		JSObjectSetProperty(js_ctx, js_desc, sg_js_name_set, js_setter, kJSPropertyAttributeNone, &js_exception);
+	}
+	JSObjectSetProperty(js_ctx, js_desc, sg_js_name_enumerable, JSValueMakeBoolean(js_ctx, !(accessor.m_attrib & DontEnum)), kJSPropertyAttributeNone, &js_exception);
+	JSObjectSetProperty(js_ctx, js_desc, sg_js_name_configurable, JSValueMakeBoolean(js_ctx, !(accessor.m_attrib & DontDelete)), kJSPropertyAttributeNone, &js_exception);
+
+	JSObjectRef js_ctor = Context::GetCurrentCache()->GetJSBuiltin(js_ctx, internal::ContextCache::kBuiltinObject);
+	JSObjectRef js_func = JSValueToObject(js_ctx, JSObjectGetProperty(js_ctx, js_ctor, sg_js_name_defineProperty, &js_exception), &js_exception);
+	JSObjectRef js_that = NULL;
+	const JSValueRef js_argv[] = { m_js_object, name->GetJSValue(), js_desc };
+	size_t js_argc = sizeof(js_argv) / sizeof(*js_argv);
+	JSObjectCallAsFunction(js_ctx, js_func, js_that, js_argc, js_argv, &js_exception);
+	return (js_exception)?(false):(true);
+}
+
 Local<Array> Object::GetPropertyNames()
 {
 	Local<Array> names = Array::New();
@@ -2426,7 +4033,7 @@ Local<Value> Object::CallAsFunction(Handle<Object> that, int argc, Handle<Value>
 		{
 			Arguments args(Isolate::GetCurrent(), Handle<Function>(Function::Cast(this)), that, that, object_template->m_call_as_function_data, argc, argv, false); // TODO: holder?
 			Handle<Value> result = object_template->m_call_as_function_invocation_callback(args);
-			return Local<Value>(result);
+			return Local<Value>(V8LIKE_MOVE(result));
 		}
 	}
 	return Local<Value>();
@@ -2454,13 +4061,13 @@ Local<Value> Object::CallAsConstructor(int argc, Handle<Value> argv[])
 
 			#if 0
 			// that->m_js_object.prototype = m_js_object.prototype;
-			JSValueRef js_prototype = JSObjectGetProperty(js_ctx, m_js_object, internal::JSStringWrap("prototype"), NULL);
-			JSObjectSetProperty(js_ctx, that->m_js_object, internal::JSStringWrap("prototype"), js_prototype, kJSPropertyAttributeDontEnum, NULL);
+			JSValueRef js_prototype = JSObjectGetProperty(js_ctx, m_js_object, sg_js_name_prototype, NULL);
+			JSObjectSetProperty(js_ctx, that->m_js_object, sg_js_name_prototype, js_prototype, kJSPropertyAttributeDontEnum, NULL);
 			#endif
 
 			#if 1
 			// that->m_js_object.__proto__ = m_js_object.prototype;
-			JSValueRef js_prototype = JSObjectGetProperty(js_ctx, m_js_object, internal::JSStringWrap("prototype"), NULL);
+			JSValueRef js_prototype = JSObjectGetProperty(js_ctx, m_js_object, sg_js_name_prototype, NULL);
 			JSObjectSetPrototype(js_ctx, that->m_js_object, js_prototype);
 			#endif
 
@@ -2479,6 +4086,7 @@ Local<Value> Object::CallAsConstructor(int argc, Handle<Value> argv[])
 }
 
 /*static*/ JSClassRef Object::sm_js_class = NULL;
+/*static*/ JSClassRef Object::sm_js_accessor_class = NULL;
 
 /*static*/ Local<Object> Object::New()
 {
@@ -2495,7 +4103,7 @@ Local<Value> Object::CallAsConstructor(int argc, Handle<Value> argv[])
 	if (value)
 	{
 		JSContextRef js_ctx = Context::GetCurrentJSContext();
-		JSValueRef js_value = value->m_js_value;
+		JSValueRef js_value = value->GetJSValue();
 		if (JSValueIsObjectOfClass(js_ctx, js_value, Object::GetJSClass()))
 		{
 			JSObjectRef js_object = JSValueToObject(js_ctx, js_value, NULL);
@@ -2539,6 +4147,87 @@ Local<Value> Object::CallAsConstructor(int argc, Handle<Value> argv[])
 	return sm_js_class;
 }
 
+/*static*/ JSClassRef Object::_CreateJSTemplateClass(JSStaticValue* js_static_values)
+{
+	for (JSStaticValue* js_static_value = js_static_values; js_static_value->name != NULL; ++js_static_value)
+	{
+		js_static_value->getProperty = Object::_JS_GetStaticValue;
+		js_static_value->setProperty = (js_static_value->attributes & kJSPropertyAttributeReadOnly)?(NULL):(Object::_JS_SetStaticValue);
+	}
+
+	// derives from the generic class, whose callbacks then only see names that are not static values
+	JSClassDefinition js_def = kJSClassDefinitionEmpty;
+	js_def.attributes = kJSClassAttributeNoAutomaticPrototype;
+	js_def.className = "Object";
+	js_def.parentClass = Object::GetJSClass();
+	js_def.staticValues = js_static_values;
+	return JSClassCreate(&js_def);
+}
+
+/*static*/ JSClassRef Object::_GetJSAccessorClass()
+{
+	if (!sm_js_accessor_class)
+	{
+		JSClassDefinition js_def = kJSClassDefinitionEmpty;
+		js_def.className = "Function";
+		js_def.finalize = Object::_JS_FinalizeAccessor;
+		js_def.callAsFunction = Object::_JS_CallAccessor;
+		sm_js_accessor_class = JSClassCreate(&js_def);
+	}
+	return sm_js_accessor_class;
+}
+
+/*static*/ void Object::_JS_FinalizeAccessor(JSObjectRef js_function)
+{
+	internal::AccessorFunction* accessor_function = (internal::AccessorFunction*) JSObjectGetPrivate(js_function);
+	if (accessor_function)
+	{
+		delete accessor_function; accessor_function = NULL;
+		JSObjectSetPrivate(js_function, NULL);
+	}
+}
+
+/**
+ * Calls the v8 getter or setter behind a native accessor
+ * property, with the object it was reached through as this.
+ */
+/*static*/ JSValueRef Object::_JS_CallAccessor(JSContextRef js_ctx, JSObjectRef js_function, JSObjectRef js_that, size_t js_argc, const JSValueRef js_argv[], JSValueRef* js_exception)
+{
+	HandleScope handle_scope;
+
+	internal::AccessorFunction* accessor_function = (internal::AccessorFunction*) JSObjectGetPrivate(js_function);
+	assert(accessor_function != NULL);
+	if ((accessor_function != NULL) && (js_that != NULL))
+	{
+		const internal::Accessor& accessor = accessor_function->m_accessor;
+		Handle<Object> that = internal::ImportObject(js_ctx, js_that);
+		AccessorInfo accessor_info(Isolate::GetCurrent(), that, that, accessor.m_data); // TODO: holder?
+		Handle<Value> result;
+		if (accessor_function->m_is_setter)
+		{
+			Handle<Value> value = internal::ImportValue(js_ctx, (js_argc > 0)?(js_argv[0]):(JSValueMakeUndefined(js_ctx)));
+			accessor.m_setter(Local<String>(accessor_function->m_name), Local<Value>(value), accessor_info);
+		}
+		else
+		{
+			result = accessor.m_getter(Local<String>(accessor_function->m_name), accessor_info);
+		}
+		if (!sg_last_exception.IsEmpty())
+		{
+			if (js_exception != NULL)
+			{
+				*js_exception = internal::ExportValue(sg_last_exception);
+			}
+			sg_last_exception._Clear();
+		}
+		if (!result.IsEmpty())
+		{
+			return internal::ExportValue(result);
+		}
+	}
+	return JSValueMakeUndefined(js_ctx);
+}
+
 /*static*/ void Object::_JS_Initialize(JSContextRef js_ctx, JSObjectRef js_object)
 {
 }
@@ -2568,25 +4257,26 @@ Local<Value> Object::CallAsConstructor(int argc, Handle<Value> argv[])
 	JSDebugPrintScriptStack(js_ctx);
 	#endif
 
+	HandleScope handle_scope;
+
 	Handle<Object> object((Object*) JSObjectGetPrivate(js_object));
 	assert(!object.IsEmpty());
 	if (!object.IsEmpty())
 	{
-		JSValueRef js_key = JSValueMakeString(js_ctx, js_name);
+		if (!object->GetHelper()->NeedsInterception())
+		{
+			return false;
+		}
+
+		internal::PropertyName name(js_ctx, js_name);
 
-		if (object->HasIndexedPropertiesInExternalArrayData())
+		uint32_t index = 0;
+		if (object->HasIndexedPropertiesInExternalArrayData() && name._AsArrayIndex(&index))
 		{
-			double key = JSValueToNumber(js_ctx, js_key, NULL);
-			double whole = 0.0;
-			if ((std::modf(key, &whole) == 0.0) && (std::numeric_limits<uint32_t>::min() <= whole) && (whole <= std::numeric_limits<uint32_t>::max()))
-			{
-				uint32_t index = internal::DoubleToUint32(whole);
-				int array_data_length = object->GetIndexedPropertiesExternalArrayDataLength();
-				return (index < array_data_length);
-			}
+			int array_data_length = object->GetIndexedPropertiesExternalArrayDataLength();
+			return (index < array_data_length);
 		}
 
-		Handle<String> name = Handle<String>(new String(js_ctx, js_key));
 		return object->_ObjectHasProperty(name);
 	}
 	return false;
@@ -2604,51 +4294,52 @@ Local<Value> Object::CallAsConstructor(int argc, Handle<Value> argv[])
 	JSDebugPrintScriptStack(js_ctx);
 	#endif
 
+	HandleScope handle_scope;
+
 	Handle<Object> object((Object*) JSObjectGetPrivate(js_object));
 	assert(!object.IsEmpty());
 	if (!object.IsEmpty())
 	{
-		JSValueRef js_key = JSValueMakeString(js_ctx, js_name);
+		if (!object->GetHelper()->NeedsInterception())
+		{
+			return NULL;
+		}
 
-		if (object->HasIndexedPropertiesInExternalArrayData())
+		internal::PropertyName name(js_ctx, js_name);
+
+		uint32_t index = 0;
+		if (object->HasIndexedPropertiesInExternalArrayData() && name._AsArrayIndex(&index))
 		{
-			double key = JSValueToNumber(js_ctx, js_key, NULL);
-			double whole = 0.0;
-			if ((std::modf(key, &whole) == 0.0) && (std::numeric_limits<uint32_t>::min() <= whole) && (whole <= std::numeric_limits<uint32_t>::max()))
+			int array_data_length = object->GetIndexedPropertiesExternalArrayDataLength();
+			if (index < array_data_length)
 			{
-				uint32_t index = internal::DoubleToUint32(whole);
-				int array_data_length = object->GetIndexedPropertiesExternalArrayDataLength();
-				if (index < array_data_length)
+				ExternalArrayType array_data_type = object->GetIndexedPropertiesExternalArrayDataType();
+				void* array_data = object->GetIndexedPropertiesExternalArrayData();
+				JSValueRef js_value = NULL;
+				switch (array_data_type)
 				{
-					ExternalArrayType array_data_type = object->GetIndexedPropertiesExternalArrayDataType();
-					void* array_data = object->GetIndexedPropertiesExternalArrayData();
-					JSValueRef js_value = NULL;
-					switch (array_data_type)
-					{
-					case kExternalByteArray:			js_value = JSValueMakeNumber(js_ctx, internal::FastI2D (((char*)		   array_data)[index])); break;
-					case kExternalShortArray:   		js_value = JSValueMakeNumber(js_ctx, internal::FastI2D (((short*)   	   array_data)[index])); break;
-					case kExternalIntArray: 			js_value = JSValueMakeNumber(js_ctx, internal::FastI2D (((int*) 		   array_data)[index])); break;
-					case kExternalPixelArray:			js_value = JSValueMakeNumber(js_ctx, internal::FastUI2D(((unsigned char*)  array_data)[index])); break;
-					case kExternalUnsignedByteArray:	js_value = JSValueMakeNumber(js_ctx, internal::FastUI2D(((unsigned char*)  array_data)[index])); break;
-					case kExternalUnsignedShortArray:   js_value = JSValueMakeNumber(js_ctx, internal::FastUI2D(((unsigned short*) array_data)[index])); break;
-					case kExternalUnsignedIntArray:		js_value = JSValueMakeNumber(js_ctx, internal::FastUI2D(((unsigned int*)   array_data)[index])); break;
-					case kExternalFloatArray:			js_value = JSValueMakeNumber(js_ctx, (double)   	   (((float*)   	   array_data)[index])); break;
-					case kExternalDoubleArray:			js_value = JSValueMakeNumber(js_ctx,				   (((double*)  	   array_data)[index])); break;
-					default: assert(0); js_value = JSValueMakeUndefined(js_ctx); break;
-					}
-					return js_value;
+				case kExternalByteArray:			js_value = JSValueMakeNumber(js_ctx, internal::FastI2D (((char*)		   array_data)[index])); break;
+				case kExternalShortArray:   		js_value = JSValueMakeNumber(js_ctx, internal::FastI2D (((short*)   	   array_data)[index])); break;
+				case kExternalIntArray: 			js_value = JSValueMakeNumber(js_ctx, internal::FastI2D (((int*) 		   array_data)[index])); break;
+				case kExternalPixelArray:			js_value = JSValueMakeNumber(js_ctx, internal::FastUI2D(((unsigned char*)  array_data)[index])); break;
+				case kExternalUnsignedByteArray:	js_value = JSValueMakeNumber(js_ctx, internal::FastUI2D(((unsigned char*)  array_data)[index])); break;
+				case kExternalUnsignedShortArray:   js_value = JSValueMakeNumber(js_ctx, internal::FastUI2D(((unsigned short*) array_data)[index])); break;
+				case kExternalUnsignedIntArray:		js_value = JSValueMakeNumber(js_ctx, internal::FastUI2D(((unsigned int*)   array_data)[index])); break;
+				case kExternalFloatArray:			js_value = JSValueMakeNumber(js_ctx, (double)   	   (((float*)   	   array_data)[index])); break;
+				case kExternalDoubleArray:			js_value = JSValueMakeNumber(js_ctx,				   (((double*)  	   array_data)[index])); break;
+				default: assert(0); js_value = JSValueMakeUndefined(js_ctx); break;
 				}
-
-				return JSValueMakeUndefined(js_ctx);
+				return js_value;
 			}
+
+			return JSValueMakeUndefined(js_ctx);
 		}
 
-		Handle<String> name = Handle<String>(new String(js_ctx, js_key));
 		Handle<Value> value = object->_ObjectGetProperty(name);
 		#if 0
 		if (value->IsObject())
 		{
-			printf("getting object %p %s as object %p\n", js_object, *String::Utf8Value(name), value->m_js_value);
+			printf("getting object %p %s as object %p\n", js_object, *String::Utf8Value(name.GetString()), value->GetJSValue());
 		}
 		else if (value->IsString())
 		{
@@ -2656,11 +4347,11 @@ Local<Value> Object::CallAsConstructor(int argc, Handle<Value> argv[])
 			const size_t length = 256; char buffer[length];
 			strncpy(buffer, *value_str, length); buffer[length - 1] = '\0';
 			if (strlen(*value_str) >= length) { strcpy(&buffer[length - 4], "..."); }
-			printf("getting object %p %s as string %p \"%s\"\n", js_object, *String::Utf8Value(name), value->m_js_value, buffer);
+			printf("getting object %p %s as string %p \"%s\"\n", js_object, *String::Utf8Value(name.GetString()), value->GetJSValue(), buffer);
 		}
 		else
 		{
-			printf("getting object %p %s as '%s'\n", js_object, *String::Utf8Value(name), *String::Utf8Value(value->ToString()));
+			printf("getting object %p %s as '%s'\n", js_object, *String::Utf8Value(name.GetString()), *String::Utf8Value(value->ToString()));
 		}
 		#endif
 		if (!value.IsEmpty())
@@ -2682,20 +4373,25 @@ Local<Value> Object::CallAsConstructor(int argc, Handle<Value> argv[])
 	JSDebugPrintScriptStack(js_ctx);
 	#endif
 
+	HandleScope handle_scope;
+
 	Handle<Object> object((Object*) JSObjectGetPrivate(js_object));
 	assert(!object.IsEmpty());
 	if (!object.IsEmpty())
 	{
-		JSValueRef js_key = JSValueMakeString(js_ctx, js_name);
+		if (!object->GetHelper()->NeedsInterception())
+		{
+			return false;
+		}
+
+		internal::PropertyName name(js_ctx, js_name);
 
-		if (object->HasIndexedPropertiesInExternalArrayData())
+		uint32_t index = 0;
+		if (object->HasIndexedPropertiesInExternalArrayData() && name._AsArrayIndex(&index))
 		{
-			double key = JSValueToNumber(js_ctx, js_key, NULL);
 			double data = JSValueToNumber(js_ctx, js_value, NULL);
-			double whole = 0.0;
-			if ((std::modf(key, &whole) == 0.0) && (std::numeric_limits<uint32_t>::min() <= whole) && (whole <= std::numeric_limits<uint32_t>::max()) && (std::isnan(data) == 0))
+			if (std::isnan(data) == 0)
 			{
-				uint32_t index = internal::DoubleToUint32(whole);
 				int array_data_length = object->GetIndexedPropertiesExternalArrayDataLength();
 				if (index < array_data_length)
 				{
@@ -2720,12 +4416,11 @@ Local<Value> Object::CallAsConstructor(int argc, Handle<Value> argv[])
 			}
 		}
 
-		Handle<String> name = Handle<String>(new String(js_ctx, js_key));
 		Handle<Value> value = internal::ImportValue(js_ctx, js_value);
 		#if 0
 		if (value->IsObject())
 		{
-			printf("setting object %p %s to object %p\n", js_object, *String::Utf8Value(name), value->m_js_value);
+			printf("setting object %p %s to object %p\n", js_object, *String::Utf8Value(name.GetString()), value->GetJSValue());
 		}
 		else if (value->IsString())
 		{
@@ -2733,11 +4428,11 @@ Local<Value> Object::CallAsConstructor(int argc, Handle<Value> argv[])
 			const size_t length = 256; char buffer[length];
 			strncpy(buffer, *value_str, length); buffer[length - 1] = '\0';
 			if (strlen(*value_str) >= length) { strcpy(&buffer[length - 4], "..."); }
-			printf("setting object %p %s to string %p \"%s\"\n", js_object, *String::Utf8Value(name), value->m_js_value, buffer);
+			printf("setting object %p %s to string %p \"%s\"\n", js_object, *String::Utf8Value(name.GetString()), value->GetJSValue(), buffer);
 		}
 		else
 		{
-			printf("setting object %p %s to '%s'\n", js_object, *String::Utf8Value(name), *String::Utf8Value(value->ToString()));
+			printf("setting object %p %s to '%s'\n", js_object, *String::Utf8Value(name.GetString()), *String::Utf8Value(value->ToString()));
 		}
 		#endif
 		return object->_ObjectSetProperty(name, value, None);
@@ -2751,23 +4446,63 @@ bool Object::_JS_DeleteProperty(JSContextRef js_ctx, JSObjectRef js_object, JSSt
 	JSDebugPrintScriptStack(js_ctx);
 	#endif
 
+	HandleScope handle_scope;
+
 	Handle<Object> object((Object*) JSObjectGetPrivate(js_object));
 	assert(!object.IsEmpty());
 	if (!object.IsEmpty())
 	{
-		JSValueRef js_key = JSValueMakeString(js_ctx, js_name);
-		Handle<String> name = Handle<String>(new String(js_ctx, js_key));
+		if (!object->GetHelper()->NeedsInterception())
+		{
+			return false;
+		}
+
+		internal::PropertyName name(js_ctx, js_name);
 		return object->_ObjectDeleteProperty(name);
 	}
 	return false;
 }
 
+/*static*/ JSValueRef Object::_JS_GetStaticValue(JSContextRef js_ctx, JSObjectRef js_object, JSStringRef js_name, JSValueRef* js_exception)
+{
+	HandleScope handle_scope;
+
+	Handle<Object> object((Object*) JSObjectGetPrivate(js_object));
+	assert(!object.IsEmpty());
+	if (!object.IsEmpty())
+	{
+		internal::PropertyName name(js_ctx, js_name);
+		Handle<Value> value = object->_ObjectGetProperty(name);
+		if (!value.IsEmpty())
+		{
+			return internal::ExportValue(value);
+		}
+	}
+	return NULL;
+}
+
+/*static*/ bool Object::_JS_SetStaticValue(JSContextRef js_ctx, JSObjectRef js_object, JSStringRef js_name, JSValueRef js_value, JSValueRef* js_exception)
+{
+	HandleScope handle_scope;
+
+	Handle<Object> object((Object*) JSObjectGetPrivate(js_object));
+	assert(!object.IsEmpty());
+	if (!object.IsEmpty())
+	{
+		internal::PropertyName name(js_ctx, js_name);
+		return object->_ObjectSetProperty(name, internal::ImportValue(js_ctx, js_value), None);
+	}
+	return false;
+}
+
 void Object::_JS_GetPropertyNames(JSContextRef js_ctx, JSObjectRef js_object, JSPropertyNameAccumulatorRef js_name_accumulator)
 {
 	#if 1 // V8LIKE_DEBUG
 	JSDebugPrintScriptStack(js_ctx);
 	#endif
 
+	HandleScope handle_scope;
+
 	Handle<Object> object((Object*) JSObjectGetPrivate(js_object));
 	assert(!object.IsEmpty());
 	if (!object.IsEmpty())
@@ -2782,6 +4517,8 @@ bool Object::_JS_HasInstance(JSContextRef js_ctx, JSObjectRef js_object, JSValue
 	JSDebugPrintScriptStack(js_ctx);
 	#endif
 
+	HandleScope handle_scope;
+
 	Handle<Object> object((Object*) JSObjectGetPrivate(js_object));
 	assert(!object.IsEmpty());
 	if (!object.IsEmpty())
@@ -2852,7 +4589,7 @@ uint32_t Array::Length() const
 {
 	JSValueRef js_exception = NULL;
 	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	JSValueRef js_length = JSObjectGetProperty(js_ctx, m_js_object, internal::JSStringWrap("length"), &js_exception);
+	JSValueRef js_length = JSObjectGetProperty(js_ctx, m_js_object, sg_js_name_length, &js_exception);
 	if (js_exception)
 	{
 		ThrowException(internal::ImportValue(js_ctx, js_exception));
@@ -2890,13 +4627,13 @@ Local<Object> Array::CloneElementAt(uint32_t index)
 	if (value)
 	{
 		JSContextRef js_ctx = Context::GetCurrentJSContext();
-		JSValueRef js_value = value->m_js_value;
+		JSValueRef js_value = value->GetJSValue();
 ///		if (JSValueIsObjectOfClass(js_ctx, js_value, Array::GetJSClass()))
 ///		{
 ///			JSObjectRef js_object = JSValueToObject(js_ctx, js_value, NULL);
 ///			return (Array*) JSObjectGetPrivate(js_object);
 ///		}
-		if (JSValueIsArray(js_ctx, js_value))
+		if (value->GetObjectKind() == Value::kObjectKindArray)
 		{
 			JSObjectRef js_object = JSValueToObject(js_ctx, js_value, NULL);
 			assert(js_object == js_value);
@@ -2992,11 +4729,9 @@ Function::Function(JSContextRef js_ctx)
 	//JSObjectSetPrototype(js_ctx, m_js_object, js_prototype);
 
 	// m_js_object.__proto__ = new Function();
-	JSStringRef js_name = JSStringCreateWithUTF8CString("Function");
-	JSObjectRef js_ctor = JSValueToObject(js_ctx, JSObjectGetProperty(js_ctx, Context::GetJSGlobalObject(js_ctx, JSContextGetGlobalObject(js_ctx)), js_name, NULL), NULL);
+	JSObjectRef js_ctor = Context::GetCurrentCache()->GetJSBuiltin(js_ctx, internal::ContextCache::kBuiltinFunction);
 	JSObjectRef js_prototype = JSObjectCallAsConstructor(js_ctx, js_ctor, 0, NULL, NULL);
 	JSObjectSetPrototype(js_ctx, m_js_object, js_prototype);
-	JSStringRelease(js_name); js_name = NULL;
 
 	assert(JSObjectGetPrivate(m_js_object) == this);
 	assert(JSValueIsObject(js_ctx, m_js_value));
@@ -3011,7 +4746,7 @@ Function::Function(JSContextRef js_ctx, JSObjectRef js_object)
 	assert(JSValueIsFunction(js_ctx, m_js_object));
 }
 
-bool Function::_FunctionHasProperty(Handle<String> name)
+bool Function::_FunctionHasProperty(const internal::PropertyName& name)
 {
 	// check function template, for Objects created by FunctionTemplate::GetFunction()->NewInstance()
 	if (!m_function_template.IsEmpty() && m_function_template->_FunctionTemplateHasProperty(Handle<Function>(this), name))
@@ -3028,7 +4763,7 @@ bool Function::_FunctionHasProperty(Handle<String> name)
 	return false;
 }
 
-Handle<Value> Function::_FunctionGetProperty(Handle<String> name)
+Handle<Value> Function::_FunctionGetProperty(const internal::PropertyName& name)
 {
 	Handle<Value> value;
 
@@ -3052,7 +4787,7 @@ Handle<Value> Function::_FunctionGetProperty(Handle<String> name)
 	return value;
 }
 
-bool Function::_FunctionSetProperty(Handle<String> name, Handle<Value> value, PropertyAttribute attrib)
+bool Function::_FunctionSetProperty(const internal::PropertyName& name, Handle<Value> value, PropertyAttribute attrib)
 {
 	// check function template, for Objects created by FunctionTemplate::GetFunction()->NewInstance()
 	if (!m_function_template.IsEmpty())
@@ -3072,7 +4807,7 @@ bool Function::_FunctionSetProperty(Handle<String> name, Handle<Value> value, Pr
 	return false;
 }
 
-bool Function::_FunctionDeleteProperty(Handle<String> name)
+bool Function::_FunctionDeleteProperty(const internal::PropertyName& name)
 {
 	// check function template, for Objects created by FunctionTemplate::GetFunction()->NewInstance()
 	if (!m_function_template.IsEmpty() && m_function_template->_FunctionTemplateDeleteProperty(Handle<Function>(this), name))
@@ -3109,7 +4844,7 @@ Local<Value> Function::Call(Handle<Object> that, int argc, Handle<Value> argv[])
 		{
 			Arguments args(Isolate::GetCurrent(), Handle<Function>(this), that, that, m_function_template->m_data, argc, argv, false); // TODO: holder?
 			Handle<Value> result = m_function_template->m_callback(args);
-			return Local<Value>(result);
+			return Local<Value>(V8LIKE_MOVE(result));
 		}
 		else
 		{
@@ -3162,13 +4897,13 @@ Local<Object> Function::NewInstance(int argc, Handle<Value> argv[]) /*const*/
 
 			#if 0
 			// that->m_js_object.prototype = m_js_object.prototype;
-			JSValueRef js_prototype = JSObjectGetProperty(js_ctx, m_js_object, internal::JSStringWrap("prototype"), NULL);
-			JSObjectSetProperty(js_ctx, that->m_js_object, internal::JSStringWrap("prototype"), js_prototype, kJSPropertyAttributeDontEnum, NULL);
+			JSValueRef js_prototype = JSObjectGetProperty(js_ctx, m_js_object, sg_js_name_prototype, NULL);
+			JSObjectSetProperty(js_ctx, that->m_js_object, sg_js_name_prototype, js_prototype, kJSPropertyAttributeDontEnum, NULL);
 			#endif
 
 			#if 1
 			// that->m_js_object.__proto__ = m_js_object.prototype;
-			JSValueRef js_prototype = JSObjectGetProperty(js_ctx, m_js_object, internal::JSStringWrap("prototype"), NULL);
+			JSValueRef js_prototype = JSObjectGetProperty(js_ctx, m_js_object, sg_js_name_prototype, NULL);
 			JSObjectSetPrototype(js_ctx, that->m_js_object, js_prototype);
 			#endif
 
@@ -3230,7 +4965,7 @@ Local<Object> Function::NewInstance(int argc, Handle<Value> argv[]) /*const*/
 	if (value)
 	{
 		JSContextRef js_ctx = Context::GetCurrentJSContext();
-		JSValueRef js_value = value->m_js_value;
+		JSValueRef js_value = value->GetJSValue();
 		if (JSValueIsObjectOfClass(js_ctx, js_value, Function::GetJSClass()))
 		{
 			JSObjectRef js_object = JSValueToObject(js_ctx, js_value, NULL);
@@ -3270,6 +5005,8 @@ Local<Object> Function::NewInstance(int argc, Handle<Value> argv[]) /*const*/
 	JSDebugPrintScriptStack(js_ctx);
 	#endif
 
+	HandleScope handle_scope;
+
 	Handle<Function> function((Function*) JSObjectGetPrivate(js_function));
 	assert(!function.IsEmpty());
 	if (!function.IsEmpty())
@@ -3301,6 +5038,8 @@ Local<Object> Function::NewInstance(int argc, Handle<Value> argv[]) /*const*/
 	JSDebugPrintScriptStack(js_ctx);
 	#endif
 
+	HandleScope handle_scope;
+
 	Handle<Function> function((Function*) JSObjectGetPrivate(js_function));
 	assert(!function.IsEmpty());
 	if (!function.IsEmpty())
@@ -3366,14 +5105,14 @@ Date::Date(JSContextRef js_ctx, JSObjectRef js_object)
 	if (value)
 	{
 		JSContextRef js_ctx = Context::GetCurrentJSContext();
-		JSValueRef js_value = value->m_js_value;
+		JSValueRef js_value = value->GetJSValue();
 ///		if (JSValueIsObjectOfClass(js_ctx, js_value, Date::GetJSClass()))
 ///		{
 ///			JSObjectRef js_object = JSValueToObject(js_ctx, js_value, NULL);
 ///			assert(JSObjectGetPrivate(js_object) != NULL);
 ///			return (Date*) JSObjectGetPrivate(js_object);
 ///		}
-		if (JSValueIsDate(js_ctx, js_value))
+		if (value->GetObjectKind() == Value::kObjectKindDate)
 		{
 			JSObjectRef js_object = JSValueToObject(js_ctx, js_value, NULL);
 			assert(js_object == js_value);
@@ -3403,7 +5142,7 @@ RTTI_IMPLEMENT(v8::RegExp, v8::Object);
 RegExp::RegExp(JSContextRef js_ctx, Handle<String> pattern, Flags flags)
 {
 	JSValueRef js_exception = NULL;
-	JSValueRef js_pattern = pattern->m_js_value;
+	JSValueRef js_pattern = pattern->GetJSValue();
 	char flags_str[4] = { '\0' };
 	if (flags & kGlobal) { strcat(flags_str, "g"); }
 	if (flags & kIgnoreCase) { strcat(flags_str, "i"); }
@@ -3444,14 +5183,14 @@ RegExp::RegExp(JSContextRef js_ctx, JSObjectRef js_object)
 	if (value)
 	{
 		JSContextRef js_ctx = Context::GetCurrentJSContext();
-		JSValueRef js_value = value->m_js_value;
+		JSValueRef js_value = value->GetJSValue();
 ///		if (JSValueIsObjectOfClass(js_ctx, js_value, RegExp::GetJSClass()))
 ///		{
 ///			JSObjectRef js_object = JSValueToObject(js_ctx, js_value, NULL);
 ///			assert(JSObjectGetPrivate(js_object) != NULL);
 ///			return (RegExp*) JSObjectGetPrivate(js_object);
 ///		}
-		if (JSValueIsRegExp(js_ctx, js_value))
+		if (value->GetObjectKind() == Value::kObjectKindRegExp)
 		{
 			JSObjectRef js_object = JSValueToObject(js_ctx, js_value, NULL);
 			assert(js_object == js_value);
@@ -3704,7 +5443,7 @@ void* External::Value() const
 	if (value)
 	{
 		JSContextRef js_ctx = Context::GetCurrentJSContext();
-		JSValueRef js_value = value->m_js_value;
+		JSValueRef js_value = value->GetJSValue();
 		if (JSValueIsObjectOfClass(js_ctx, js_value, External::GetJSClass()))
 		{
 			JSObjectRef js_object = JSValueToObject(js_ctx, js_value, NULL);
@@ -3887,15 +5626,35 @@ ObjectTemplate::ObjectTemplate() :
 	m_access_check_indexed_security_callback(NULL),
 	m_access_check_turned_on_by_default(true),
 	m_internal_field_count(0),
-	m_undetectable(false)
+	m_undetectable(false),
+	m_version(++sm_version_counter),
+	m_lookup_version(m_version),
+	m_js_class(NULL),
+	m_js_class_version(0) // stale until the first NewInstance
 {
 }
 
 ObjectTemplate::~ObjectTemplate()
 {
+	if (m_js_class)
+	{
+		JSClassRelease(m_js_class); m_js_class = NULL; // instances hold their own references
+	}
+}
+
+/*static*/ uint32_t ObjectTemplate::sm_version_counter = 0;
+
+uint32_t ObjectTemplate::_GetChainVersion() const
+{
+	uint32_t version = m_version;
+	for (const ObjectTemplate* object_template = *m_prototype_template; object_template != NULL; object_template = *object_template->m_prototype_template)
+	{
+		version = (object_template->m_version > version)?(object_template->m_version):(version);
+	}
+	return version;
 }
 
-bool ObjectTemplate::_ObjectTemplateHasProperty(Handle<Object> object, Handle<String> name)
+bool ObjectTemplate::_ObjectTemplateHasProperty(Handle<Object> object, const internal::PropertyName& name)
 {
 	// check object template accessor map
 	internal::TemplateAccessorMap::iterator template_accessor_it = m_template_accessor_map.find(name);
@@ -3908,17 +5667,15 @@ bool ObjectTemplate::_ObjectTemplateHasProperty(Handle<Object> object, Handle<St
 	if (m_named_property_query)
 	{
 		AccessorInfo accessor_info(Isolate::GetCurrent(), object, object, m_named_property_data); // TODO: holder?
-		Handle<Integer> value = m_named_property_query(Local<String>(name), accessor_info);
+		Handle<Integer> value = m_named_property_query(Local<String>(name.GetString()), accessor_info);
 		return !value.IsEmpty();
 	}
 
 	// check object template indexed_property_query
 	if (m_indexed_property_query)
 	{
-		JSValueRef js_exception = NULL;
-		JSContextRef js_ctx = Context::GetCurrentJSContext();
-		uint32_t index = internal::DoubleToUint32(JSValueToNumber(js_ctx, name->m_js_value, &js_exception));
-		if (js_exception == NULL)
+		uint32_t index = 0;
+		if (name._AsArrayIndex(&index))
 		{
 			AccessorInfo accessor_info(Isolate::GetCurrent(), object, object, m_indexed_property_data); // TODO: holder?
 			Handle<Integer> value = m_indexed_property_query(index, accessor_info);
@@ -3935,59 +5692,103 @@ bool ObjectTemplate::_ObjectTemplateHasProperty(Handle<Object> object, Handle<St
 	return false;
 }
 
-Handle<Value> ObjectTemplate::_ObjectTemplateGetProperty(Handle<Object> object, Handle<String> name)
+Handle<Value> ObjectTemplate::_ObjectTemplateGetProperty(Handle<Object> object, const internal::PropertyName& name)
 {
-	Handle<Value> value;
-
-	// check object template accessor map
-	internal::TemplateAccessorMap::iterator template_accessor_it = m_template_accessor_map.find(name);
-	if (template_accessor_it != m_template_accessor_map.end())
+	const uint32_t chain_version = _GetChainVersion();
+	if (m_lookup_version != chain_version)
 	{
-		AccessorInfo accessor_info(Isolate::GetCurrent(), object, object, template_accessor_it->second.m_data); // TODO: holder?
-		return template_accessor_it->second.m_getter(Local<String>(name), accessor_info);
+		m_lookup_cache.clear();
+		m_lookup_version = chain_version;
 	}
 
-	// check object template named_property_getter
-	if (m_named_property_getter)
+	internal::TemplateLookupCache::iterator lookup_it = m_lookup_cache.find(name);
+	if (lookup_it == m_lookup_cache.end())
 	{
-		AccessorInfo accessor_info(Isolate::GetCurrent(), object, object, m_named_property_data); // TODO: holder?
-		return m_named_property_getter(Local<String>(name), accessor_info);
+		if (m_lookup_cache.size() >= kLookupCacheMaxSize)
+		{
+			m_lookup_cache.clear(); // a named getter sees an unbounded set of names
+		}
+		m_lookup_cache[name.GetString()] = _ObjectTemplateResolveGetter(name);
+		lookup_it = m_lookup_cache.find(name);
 	}
+	const internal::TemplateLookup& lookup = lookup_it->second;
 
-	// check object template indexed_property_getter
-	if (m_indexed_property_getter)
+	switch (lookup.m_kind)
 	{
-		JSValueRef js_exception = NULL;
-		JSContextRef js_ctx = Context::GetCurrentJSContext();
-		uint32_t index = internal::DoubleToUint32(JSValueToNumber(js_ctx, name->m_js_value, &js_exception));
-		if (js_exception == NULL)
+	case internal::TemplateLookup::kKindAccessor:
 		{
-			AccessorInfo accessor_info(Isolate::GetCurrent(), object, object, m_indexed_property_data); // TODO: holder?
-			return m_indexed_property_getter(index, accessor_info);
+			AccessorInfo accessor_info(Isolate::GetCurrent(), object, object, lookup.m_accessor->m_data); // TODO: holder?
+			return lookup.m_accessor->m_getter(Local<String>(*lookup.m_accessor_name), accessor_info);
+		}
+	case internal::TemplateLookup::kKindNamedGetter:
+		{
+			AccessorInfo accessor_info(Isolate::GetCurrent(), object, object, lookup.m_holder->m_named_property_data); // TODO: holder?
+			return lookup.m_holder->m_named_property_getter(Local<String>(name.GetString()), accessor_info);
+		}
+	case internal::TemplateLookup::kKindIndexedGetter:
+		{
+			uint32_t index = 0;
+			if (name._AsArrayIndex(&index))
+			{
+				AccessorInfo accessor_info(Isolate::GetCurrent(), object, object, lookup.m_holder->m_indexed_property_data); // TODO: holder?
+				return lookup.m_holder->m_indexed_property_getter(index, accessor_info);
+			}
+			break;
 		}
+	default:
+		break;
 	}
 
-	// check object prototype template
-	if (!m_prototype_template.IsEmpty())
+	return Handle<Value>();
+}
+
+internal::TemplateLookup ObjectTemplate::_ObjectTemplateResolveGetter(const internal::PropertyName& name)
+{
+	internal::TemplateLookup lookup;
+
+	// same order as the handlers are tried in, up the prototype templates
+	for (ObjectTemplate* object_template = this; object_template != NULL; object_template = *object_template->m_prototype_template)
 	{
-		value = m_prototype_template->_ObjectTemplateGetProperty(object, name);
-		if (!value.IsEmpty())
+		// check object template accessor map
+		internal::TemplateAccessorMap::iterator template_accessor_it = object_template->m_template_accessor_map.find(name);
+		if (template_accessor_it != object_template->m_template_accessor_map.end())
 		{
-			return value;
+			lookup.m_kind = internal::TemplateLookup::kKindAccessor;
+			lookup.m_holder = object_template;
+			lookup.m_accessor = &template_accessor_it->second;
+			lookup.m_accessor_name = &template_accessor_it->first;
+			break;
+		}
+
+		// check object template named_property_getter
+		if (object_template->m_named_property_getter)
+		{
+			lookup.m_kind = internal::TemplateLookup::kKindNamedGetter;
+			lookup.m_holder = object_template;
+			break;
+		}
+
+		// check object template indexed_property_getter, which only sees array indices
+		uint32_t index = 0;
+		if (object_template->m_indexed_property_getter && name._AsArrayIndex(&index))
+		{
+			lookup.m_kind = internal::TemplateLookup::kKindIndexedGetter;
+			lookup.m_holder = object_template;
+			break;
 		}
 	}
 
-	return value;
+	return lookup;
 }
 
-bool ObjectTemplate::_ObjectTemplateSetProperty(Handle<Object> object, Handle<String> name, Handle<Value> value)
+bool ObjectTemplate::_ObjectTemplateSetProperty(Handle<Object> object, const internal::PropertyName& name, Handle<Value> value)
 {
 	// check object template accessor map
 	internal::TemplateAccessorMap::iterator template_accessor_it = m_template_accessor_map.find(name);
 	if (template_accessor_it != m_template_accessor_map.end())
 	{
 		AccessorInfo accessor_info(Isolate::GetCurrent(), object, object, template_accessor_it->second.m_data); // TODO: holder?
-		template_accessor_it->second.m_setter(Local<String>(name), Local<Value>(value), accessor_info);
+		template_accessor_it->second.m_setter(Local<String>(template_accessor_it->first), Local<Value>(value), accessor_info);
 		return true;
 	}
 
@@ -3995,7 +5796,7 @@ bool ObjectTemplate::_ObjectTemplateSetProperty(Handle<Object> object, Handle<St
 	if (m_named_property_setter)
 	{
 		AccessorInfo accessor_info(Isolate::GetCurrent(), object, object, m_named_property_data); // TODO: holder?
-		if (value == m_named_property_setter(Local<String>(name), Local<Value>(value), accessor_info))
+		if (value == m_named_property_setter(Local<String>(name.GetString()), Local<Value>(value), accessor_info))
 		{
 			return true;
 		}
@@ -4004,10 +5805,8 @@ bool ObjectTemplate::_ObjectTemplateSetProperty(Handle<Object> object, Handle<St
 	// check object template indexed_property_setter
 	if (m_indexed_property_setter)
 	{
-		JSValueRef js_exception = NULL;
-		JSContextRef js_ctx = Context::GetCurrentJSContext();
-		uint32_t index = internal::DoubleToUint32(JSValueToNumber(js_ctx, name->m_js_value, &js_exception));
-		if (js_exception == NULL)
+		uint32_t index = 0;
+		if (name._AsArrayIndex(&index))
 		{
 			AccessorInfo accessor_info(Isolate::GetCurrent(), object, object, m_indexed_property_data); // TODO: holder?
 			if (value == m_indexed_property_setter(index, Local<Value>(value), accessor_info))
@@ -4026,7 +5825,7 @@ bool ObjectTemplate::_ObjectTemplateSetProperty(Handle<Object> object, Handle<St
 	return false;
 }
 
-bool ObjectTemplate::_ObjectTemplateDeleteProperty(Handle<Object> object, Handle<String> name)
+bool ObjectTemplate::_ObjectTemplateDeleteProperty(Handle<Object> object, const internal::PropertyName& name)
 {
 //	// check object template accessor map
 //	internal::TemplateAccessorMap::iterator template_accessor_it = m_template_accessor_map.find(name);
@@ -4040,17 +5839,15 @@ bool ObjectTemplate::_ObjectTemplateDeleteProperty(Handle<Object> object, Handle
 	if (m_named_property_deleter)
 	{
 		AccessorInfo accessor_info(Isolate::GetCurrent(), object, object, m_named_property_data); // TODO: holder?
-		Handle<Boolean> value = m_named_property_deleter(Local<String>(name), accessor_info);
+		Handle<Boolean> value = m_named_property_deleter(Local<String>(name.GetString()), accessor_info);
 		return !value.IsEmpty() && value->Value();
 	}
 
 	// check object template indexed_property_deleter
 	if (m_indexed_property_deleter)
 	{
-		JSValueRef js_exception = NULL;
-		JSContextRef js_ctx = Context::GetCurrentJSContext();
-		uint32_t index = internal::DoubleToUint32(JSValueToNumber(js_ctx, name->m_js_value, &js_exception));
-		if (js_exception == NULL)
+		uint32_t index = 0;
+		if (name._AsArrayIndex(&index))
 		{
 			AccessorInfo accessor_info(Isolate::GetCurrent(), object, object, m_indexed_property_data); // TODO: holder?
 			Handle<Boolean> value = m_indexed_property_deleter(index, accessor_info);
@@ -4076,7 +5873,7 @@ void ObjectTemplate::_ObjectTemplateGetPropertyNames(Handle<Object> object, JSPr
 	{
 		if (!(template_accessor_it->second.m_attrib & DontEnum))
 		{
-			JSStringRef js_name = JSValueToStringCopy(js_ctx, template_accessor_it->first->m_js_value, NULL);
+			JSStringRef js_name = JSValueToStringCopy(js_ctx, template_accessor_it->first->GetJSValue(), NULL);
 			JSPropertyNameAccumulatorAddName(js_name_accumulator, js_name);
 			JSStringRelease(js_name);
 		}
@@ -4093,7 +5890,7 @@ void ObjectTemplate::_ObjectTemplateGetPropertyNames(Handle<Object> object, JSPr
 			for (uint32_t index = 0; index < length; ++index)
 			{
 				Handle<Value> name = names->Get(index);
-				JSStringRef js_name = JSValueToStringCopy(js_ctx, name->m_js_value, NULL);
+				JSStringRef js_name = JSValueToStringCopy(js_ctx, name->GetJSValue(), NULL);
 				JSPropertyNameAccumulatorAddName(js_name_accumulator, js_name);
 				JSStringRelease(js_name);
 			}
@@ -4111,7 +5908,7 @@ void ObjectTemplate::_ObjectTemplateGetPropertyNames(Handle<Object> object, JSPr
 			for (uint32_t index = 0; index < length; ++index)
 			{
 				Handle<Value> name = names->Get(index);
-				JSStringRef js_name = JSValueToStringCopy(js_ctx, name->m_js_value, NULL);
+				JSStringRef js_name = JSValueToStringCopy(js_ctx, name->GetJSValue(), NULL);
 				JSPropertyNameAccumulatorAddName(js_name_accumulator, js_name);
 				JSStringRelease(js_name);
 			}
@@ -4125,24 +5922,101 @@ void ObjectTemplate::_ObjectTemplateGetPropertyNames(Handle<Object> object, JSPr
 	}
 }
 
+JSClassRef ObjectTemplate::_GetJSClass()
+{
+	const uint32_t chain_version = _GetChainVersion();
+	if (m_js_class_version == chain_version)
+	{
+		return (m_js_class)?(m_js_class):(Object::GetJSClass());
+	}
+	m_js_class_version = chain_version;
+	if (m_js_class)
+	{
+		JSClassRelease(m_js_class); m_js_class = NULL;
+	}
+
+	// interceptors can answer for any name, so those chains keep the generic class
+	for (ObjectTemplate* object_template = this; object_template != NULL; object_template = *object_template->m_prototype_template)
+	{
+		if (object_template->m_named_property_getter || object_template->m_named_property_setter ||
+			object_template->m_named_property_query || object_template->m_named_property_deleter ||
+			object_template->m_named_property_enumerator ||
+			object_template->m_indexed_property_getter || object_template->m_indexed_property_setter ||
+			object_template->m_indexed_property_query || object_template->m_indexed_property_deleter ||
+			object_template->m_indexed_property_enumerator)
+		{
+			return Object::GetJSClass();
+		}
+	}
+
+	// one static value per accessor name, nearest template first
+	std::vector<char> js_names;
+	std::vector<size_t> js_name_offsets;
+	std::vector<JSStaticValue> js_static_values;
+	for (ObjectTemplate* object_template = this; object_template != NULL; object_template = *object_template->m_prototype_template)
+	{
+		internal::TemplateAccessorMap& template_accessor_map = object_template->m_template_accessor_map;
+		for (internal::TemplateAccessorMap::iterator template_accessor_it = template_accessor_map.begin(); template_accessor_it != template_accessor_map.end(); ++template_accessor_it)
+		{
+			bool is_shadowed = false;
+			for (ObjectTemplate* nearer_template = this; nearer_template != object_template; nearer_template = *nearer_template->m_prototype_template)
+			{
+				if (nearer_template->m_template_accessor_map.find(template_accessor_it->first) != nearer_template->m_template_accessor_map.end())
+				{
+					is_shadowed = true;
+					break;
+				}
+			}
+			if (is_shadowed)
+			{
+				continue;
+			}
+
+			const internal::TemplateAccessor& accessor = template_accessor_it->second;
+			JSStaticValue js_static_value = { NULL, NULL, NULL, kJSPropertyAttributeNone };
+			if ((accessor.m_attrib & ReadOnly) || (accessor.m_setter == NULL)) { js_static_value.attributes |= kJSPropertyAttributeReadOnly; }
+			if (accessor.m_attrib & DontEnum)   { js_static_value.attributes |= kJSPropertyAttributeDontEnum; }
+			if (accessor.m_attrib & DontDelete) { js_static_value.attributes |= kJSPropertyAttributeDontDelete; }
+			js_static_values.push_back(js_static_value);
+
+			String::Utf8Value name(template_accessor_it->first);
+			js_name_offsets.push_back(js_names.size());
+			js_names.insert(js_names.end(), *name, *name + name.length() + 1);
+		}
+	}
+	for (size_t i = 0; i < js_static_values.size(); ++i)
+	{
+		js_static_values[i].name = &js_names[js_name_offsets[i]];
+	}
+	JSStaticValue js_static_value_end = { NULL, NULL, NULL, kJSPropertyAttributeNone };
+	js_static_values.push_back(js_static_value_end);
+
+	// JSClassCreate copies the names
+	m_js_class = Object::_CreateJSTemplateClass(&js_static_values[0]);
+	return m_js_class;
+}
+
 Local<Object> ObjectTemplate::NewInstance()
 {
-	Handle<Object> object = Object::New();
+	Handle<Object> object(new Object(Context::GetCurrentJSContext(), _GetJSClass()));
 	//printf("ObjectTemplate::NewInstance object %p\n", object->m_js_object);
 	ObjectTemplate::ApplyToObject(object);
 	internal::Helper* helper = object->GetHelper();
 	helper->m_object_template = Handle<ObjectTemplate>(this);
+	helper->m_js_class = m_js_class; // the object keeps its class alive, so the pointer can't be reused
 	helper->SetInternalFieldCount(m_internal_field_count);
-	return Local<Object>(object);
+	return Local<Object>(V8LIKE_MOVE(object));
 }
 
 void ObjectTemplate::SetAccessor(Handle<String> name, AccessorGetter getter, AccessorSetter setter, Handle<Value> data, AccessControl settings, PropertyAttribute attrib, Handle<AccessorSignature> signature)
 {
+	m_version = ++sm_version_counter;
 	m_template_accessor_map[name] = internal::TemplateAccessor(getter, setter, data, settings, attrib, signature);
 }
 
 void ObjectTemplate::SetNamedPropertyHandler(NamedPropertyGetter getter, NamedPropertySetter setter, NamedPropertyQuery query, NamedPropertyDeleter deleter, NamedPropertyEnumerator enumerator, Handle<Value> data)
 {
+	m_version = ++sm_version_counter;
 	m_named_property_getter = getter;
 	m_named_property_setter = setter;
 	m_named_property_query = query;
@@ -4153,6 +6027,7 @@ void ObjectTemplate::SetNamedPropertyHandler(NamedPropertyGetter getter, NamedPr
 
 void ObjectTemplate::SetIndexedPropertyHandler(IndexedPropertyGetter getter, IndexedPropertySetter setter, IndexedPropertyQuery query, IndexedPropertyDeleter deleter, IndexedPropertyEnumerator enumerator, Handle<Value> data)
 {
+	m_version = ++sm_version_counter;
 	m_indexed_property_getter = getter;
 	m_indexed_property_setter = setter;
 	m_indexed_property_query = query;
@@ -4192,6 +6067,7 @@ void ObjectTemplate::SetInternalFieldCount(int value)
 
 void ObjectTemplate::SetPrototypeTemplate(Handle<ObjectTemplate> prototype_template)
 {
+	m_version = ++sm_version_counter;
 	m_prototype_template = prototype_template;
 }
 
@@ -4225,7 +6101,7 @@ FunctionTemplate::~FunctionTemplate()
 {
 }
 
-bool FunctionTemplate::_FunctionTemplateHasProperty(Handle<Function> function, Handle<String> name)
+bool FunctionTemplate::_FunctionTemplateHasProperty(Handle<Function> function, const internal::PropertyName& name)
 {
 	// check instance object template, also checks prototype object template
 	if (!m_instance_template.IsEmpty() && m_instance_template->_ObjectTemplateHasProperty(function, name))
@@ -4236,7 +6112,7 @@ bool FunctionTemplate::_FunctionTemplateHasProperty(Handle<Function> function, H
 	return false;
 }
 
-Handle<Value> FunctionTemplate::_FunctionTemplateGetProperty(Handle<Function> function, Handle<String> name)
+Handle<Value> FunctionTemplate::_FunctionTemplateGetProperty(Handle<Function> function, const internal::PropertyName& name)
 {
 	Handle<Value> value;
 
@@ -4253,7 +6129,7 @@ Handle<Value> FunctionTemplate::_FunctionTemplateGetProperty(Handle<Function> fu
 	return value;
 }
 
-bool FunctionTemplate::_FunctionTemplateSetProperty(Handle<Function> function, Handle<String> name, Handle<Value> value)
+bool FunctionTemplate::_FunctionTemplateSetProperty(Handle<Function> function, const internal::PropertyName& name, Handle<Value> value)
 {
 	// check instance object template, also checks prototype object template
 	if (!m_instance_template.IsEmpty() && m_instance_template->_ObjectTemplateSetProperty(function, name, value))
@@ -4264,7 +6140,7 @@ bool FunctionTemplate::_FunctionTemplateSetProperty(Handle<Function> function, H
 	return false;
 }
 
-bool FunctionTemplate::_FunctionTemplateDeleteProperty(Handle<Function> function, Handle<String> name)
+bool FunctionTemplate::_FunctionTemplateDeleteProperty(Handle<Function> function, const internal::PropertyName& name)
 {
 	// check instance object template, also checks prototype object template
 	if (!m_instance_template.IsEmpty() && m_instance_template->_ObjectTemplateDeleteProperty(function, name))
@@ -4298,7 +6174,7 @@ Local<Function> FunctionTemplate::GetFunction()
 
 void FunctionTemplate::Inherit(Handle<FunctionTemplate> parent)
 {
-	InstanceTemplate()->m_prototype_template = parent->InstanceTemplate()->m_prototype_template;
+	InstanceTemplate()->SetPrototypeTemplate(parent->InstanceTemplate()->m_prototype_template);
 }
 
 Local<ObjectTemplate> FunctionTemplate::InstanceTemplate()
@@ -4359,17 +6235,17 @@ bool Script::CheckSyntax()
 
 	JSValueRef js_exception = NULL;
 	JSContextRef js_ctx = context->m_js_global_ctx;
-	JSStringRef js_script = JSValueToStringCopy(js_ctx, m_source->m_js_value, NULL);
+	JSStringRef js_script = JSValueToStringCopy(js_ctx, m_source->GetJSValue(), NULL);
 	JSStringRef js_file = NULL; int js_line = 0;
 
 	if (!m_file_name.IsEmpty())
 	{
-		js_file = JSValueToStringCopy(js_ctx, m_file_name->m_js_value, NULL);
+		js_file = JSValueToStringCopy(js_ctx, m_file_name->GetJSValue(), NULL);
 	}
 
 	if (!m_line_number.IsEmpty())
 	{
-		js_line = (int) internal::DoubleToInt32(JSValueToNumber(js_ctx, m_line_number->m_js_value, NULL));
+		js_line = (int) internal::DoubleToInt32(JSValueToNumber(js_ctx, m_line_number->GetJSValue(), NULL));
 	}
 
 	bool check = JSCheckScriptSyntax(js_ctx, js_script, js_file, js_line, &js_exception);
@@ -4410,7 +6286,7 @@ Local<Value> Script::Run()
 
 	JSValueRef js_exception = NULL;
 	JSContextRef js_ctx = context->m_js_global_ctx;
-	JSValueRef js_source = m_source->m_js_value;
+	JSValueRef js_source = m_source->GetJSValue();
 
 	#if 1 // V8LIKE_NODE_BUFFER_WRAP_CTOR
 	internal::JSStringWrap js_name_arg0("source");
@@ -4427,12 +6303,12 @@ Local<Value> Script::Run()
 
 	if (!m_file_name.IsEmpty())
 	{
-		js_file = JSValueToStringCopy(js_ctx, m_file_name->m_js_value, NULL);
+		js_file = JSValueToStringCopy(js_ctx, m_file_name->GetJSValue(), NULL);
 	}
 
 	if (!m_line_number.IsEmpty())
 	{
-		js_line = (int) internal::DoubleToInt32(JSValueToNumber(js_ctx, m_line_number->m_js_value, NULL));
+		js_line = (int) internal::DoubleToInt32(JSValueToNumber(js_ctx, m_line_number->GetJSValue(), NULL));
 	}
 
 	JSValueRef js_value = JSEvaluateScript(js_ctx, js_script, js_that, js_file, js_line, &js_exception);
@@ -4460,7 +6336,7 @@ Local<Value> Script::Run()
 {
 	Handle<Script> script(new Script(source, origin->m_resource_name, origin->m_resource_line_offset, script_data));
 	script->CheckSyntax();
-	return Local<Script>(script);
+	return Local<Script>(V8LIKE_MOVE(script));
 }
 
 /*static*/ Local<Script> Script::New(Handle<String> source, Handle<Value> file_name)
@@ -4474,7 +6350,7 @@ Local<Value> Script::Run()
 	Handle<Script> script(new Script(source, origin->m_resource_name, origin->m_resource_line_offset, script_data));
 	script->m_context = Context::GetCurrent(); // bind to current context
 	script->CheckSyntax();
-	return Local<Script>(script);
+	return Local<Script>(V8LIKE_MOVE(script));
 }
 
 /*static*/ Local<Script> Script::Compile(Handle<String> source, Handle<Value> file_name, Handle<String> script_data)
@@ -4516,6 +6392,17 @@ Context::Context()
 	// push global context into the JSContextRef stack
 	m_js_ctx_stack.push_back(m_js_global_ctx);
 
+	if (sm_initial_cache != NULL)
+	{
+		// take ownership of the initial cache
+		m_cache = sm_initial_cache;
+		sm_initial_cache = NULL;
+	}
+	else
+	{
+		m_cache = new internal::ContextCache(m_js_global_ctx);
+	}
+
 	// initialize global object
 	JSObjectRef js_global_object = Context::GetJSGlobalObject(m_js_global_ctx);
 	m_global_object = Handle<Object>(new Object(m_js_global_ctx, js_global_object));
@@ -4559,6 +6446,7 @@ void Context::Exit()
 /*static*/ JSGlobalContextRef Context::sm_initial_js_global_ctx = NULL;
 /*static*/ std::map<JSContextRef, JSObjectRef> Context::sm_js_global_object_map;
 /*static*/ Persistent<Context> Context::sm_initial_context;
+/*static*/ internal::ContextCache* Context::sm_initial_cache = NULL;
 /*static*/ Persistent<Context> Context::sm_entered_context;
 /*static*/ Persistent<Context> Context::sm_current_context;
 /*static*/ Persistent<Context> Context::sm_calling_context;
@@ -4589,6 +6477,9 @@ void Context::Exit()
 {
 	if (!sm_js_class)
 	{
+		// every JS context is created with this class, so the names exist before any lookup
+		JSNamesCreate();
+
 		JSClassDefinition js_def = kJSClassDefinitionEmpty;
 		js_def.attributes = kJSClassAttributeNoAutomaticPrototype;
 		js_def.className = "Context";
@@ -4681,10 +6572,33 @@ void Context::Exit()
 	return js_global_object;
 }
 
+/*static*/ internal::ContextCache* Context::GetCurrentCache()
+{
+	if (!sm_current_context.IsEmpty())
+	{
+		return sm_current_context->m_cache;
+	}
+	else if (!sm_initial_context.IsEmpty())
+	{
+		return sm_initial_context->m_cache;
+	}
+	else
+	{
+		if (sm_initial_cache == NULL)
+		{
+			sm_initial_cache = new internal::ContextCache(Context::GetCurrentJSGlobalContext());
+		}
+
+		return sm_initial_cache;
+	}
+}
+
 static bool sg_expose_gc = true;
 
 static JSValueRef GC(JSContextRef js_ctx, JSObjectRef js_function, JSObjectRef js_this, size_t js_argc, const JSValueRef js_argv[], JSValueRef* js_exception)
 {
+	internal::ProtectJournal::GetInstance()->Flush(); // let journaled values be collected
+
 	if ((js_argc > 0) && (JSValueIsNumber(js_ctx, js_argv[0])) && (JSValueToNumber(js_ctx, js_argv[0], NULL) > 0.0))
 	{
 		JSGarbageCollect(Context::GetCurrentJSGlobalContext()); // async
@@ -4743,13 +6657,13 @@ static JSValueRef GC(JSContextRef js_ctx, JSObjectRef js_function, JSObjectRef j
 		JSValueRef js_exception = NULL;
 		JSContextRef js_ctx = context->m_js_global_ctx;
 		JSObjectRef js_global_object = global_object->m_js_object;
-		JSObjectRef js_constructor = JSValueToObject(js_ctx, JSObjectGetProperty(js_ctx, js_global_object, internal::JSStringWrap("Error"), &js_exception), &js_exception);
-		JSValueRef js_function = JSObjectGetProperty(js_ctx, js_constructor, internal::JSStringWrap("captureStackTrace"), &js_exception);
+		JSObjectRef js_constructor = JSValueToObject(js_ctx, JSObjectGetProperty(js_ctx, js_global_object, sg_js_name_Error, &js_exception), &js_exception);
+		JSValueRef js_function = JSObjectGetProperty(js_ctx, js_constructor, sg_js_name_captureStackTrace, &js_exception);
 		if (js_function == NULL)
 		{
-			js_function = JSObjectMakeFunction(js_ctx, internal::JSStringWrap("captureStackTrace"), 0, NULL, internal::JSStringWrap(""), NULL, 0, &js_exception);
+			js_function = JSObjectMakeFunction(js_ctx, sg_js_name_captureStackTrace, 0, NULL, internal::JSStringWrap(""), NULL, 0, &js_exception);
 			JSPropertyAttributes js_attrib = kJSPropertyAttributeReadOnly | kJSPropertyAttributeDontEnum | kJSPropertyAttributeDontDelete;
-			JSObjectSetProperty(js_ctx, js_constructor, internal::JSStringWrap("captureStackTrace"), js_function, js_attrib, &js_exception);
+			JSObjectSetProperty(js_ctx, js_constructor, sg_js_name_captureStackTrace, js_function, js_attrib, &js_exception);
 		}
 	}
 
@@ -4869,7 +6783,7 @@ static JSValueRef sg_node_buffer_constructor = NULL;
 	assert(JSValueIsStrictEqual(js_ctx, Context::GetJSGlobalObject(js_ctx, js_object), js_object));
 
 	#if 1 // V8LIKE_NODE_BUFFER_WRAP_CTOR
-	if (JSStringIsEqualToUTF8CString(js_name, "Buffer"))
+	if (JSStringIsEqual(js_name, sg_js_name_Buffer))
 	{
 		return (sg_node_buffer_constructor != NULL);
 	}
@@ -4889,7 +6803,7 @@ static JSValueRef sg_node_buffer_constructor = NULL;
 	assert(JSValueIsStrictEqual(js_ctx, Context::GetJSGlobalObject(js_ctx, js_object), js_object));
 
 	#if 1 // V8LIKE_NODE_BUFFER_WRAP_CTOR
-	if (JSStringIsEqualToUTF8CString(js_name, "Buffer"))
+	if (JSStringIsEqual(js_name, sg_js_name_Buffer))
 	{
 		if (sg_node_buffer_constructor != NULL)
 		{
@@ -4922,7 +6836,7 @@ static JSValueRef sg_node_buffer_constructor = NULL;
 	#endif
 
 	#if 1 // V8LIKE_NODE_BUFFER_WRAP_CTOR
-	if (JSStringIsEqualToUTF8CString(js_name, "Buffer"))
+	if (JSStringIsEqual(js_name, sg_js_name_Buffer))
 	{
 		if (sg_node_buffer_constructor != js_value)
 		{
@@ -4948,7 +6862,7 @@ bool Context::_JS_DeleteProperty(JSContextRef js_ctx, JSObjectRef js_object, JSS
 	assert(JSValueIsStrictEqual(js_ctx, Context::GetJSGlobalObject(js_ctx, js_object), js_object));
 
 	#if 1 // V8LIKE_NODE_BUFFER_WRAP_CTOR
-	if (JSStringIsEqualToUTF8CString(js_name, "Buffer"))
+	if (JSStringIsEqual(js_name, sg_js_name_Buffer))
 	{
 		if (sg_node_buffer_constructor != NULL)
 		{
@@ -4968,9 +6882,7 @@ void Context::_JS_GetPropertyNames(JSContextRef js_ctx, JSObjectRef js_object, J
 	#if 1 // V8LIKE_NODE_BUFFER_WRAP_CTOR
 	if (sg_node_buffer_constructor != NULL)
 	{
-		JSStringRef js_name = JSStringCreateWithUTF8CString("Buffer");
-		JSPropertyNameAccumulatorAddName(js_name_accumulator, js_name);
-		JSStringRelease(js_name);
+		JSPropertyNameAccumulatorAddName(js_name_accumulator, sg_js_name_Buffer);
 	}
 	#endif
 }
@@ -5003,26 +6915,22 @@ void Context::_JS_GetPropertyNames(JSContextRef js_ctx, JSObjectRef js_object, J
 
 /*static*/ Handle<Primitive> Undefined()
 {
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return Handle<Primitive>(new Primitive(js_ctx, JSValueMakeUndefined(js_ctx)));
+	return Handle<Primitive>(Context::GetCurrentCache()->m_undefined_value);
 }
 
 /*static*/ Handle<Primitive> Null()
 {
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return Handle<Primitive>(new Primitive(js_ctx, JSValueMakeNull(js_ctx)));
+	return Handle<Primitive>(Context::GetCurrentCache()->m_null_value);
 }
 
 /*static*/ Handle<Boolean> True()
 {
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return Handle<Boolean>(new Boolean(js_ctx, JSValueMakeBoolean(js_ctx, true)));
+	return Handle<Boolean>(Context::GetCurrentCache()->m_true_value);
 }
 
 /*static*/ Handle<Boolean> False()
 {
-	JSContextRef js_ctx = Context::GetCurrentJSContext();
-	return Handle<Boolean>(new Boolean(js_ctx, JSValueMakeBoolean(js_ctx, false)));
+	return Handle<Boolean>(Context::GetCurrentCache()->m_false_value);
 }
 
 /// v8::ResourceConstraints
@@ -5144,6 +7052,7 @@ HeapStatistics::HeapStatistics() :
 		printf("%s: %ld\n", __PRETTY_FUNCTION__, _bytes);
 	}
 
+	internal::ProtectJournal::GetInstance()->Flush();
 	JSGarbageCollect(Context::GetCurrentJSGlobalContext());
 
 	return _bytes;
@@ -5156,7 +7065,13 @@ HeapStatistics::HeapStatistics() :
 /*static*/ void V8::TerminateExecution(Isolate* isolate) { TODO(); }
 /*static*/ bool V8::IsExecutionTerminating(Isolate* isolate) { TODO(); return false; }
 /*static*/ bool V8::Dispose() { TODO(); return false; }
-/*static*/ void V8::GetHeapStatistics(HeapStatistics* heap_statistics) { TODO(); }
+/*static*/ void V8::GetHeapStatistics(HeapStatistics* heap_statistics)
+{
+	// JSC does not expose its heap, so report the wrapper slabs
+	internal::SlabAllocator* allocator = internal::SlabAllocator::GetInstance();
+	heap_statistics->set_total_heap_size(allocator->GetReservedBytes());
+	heap_statistics->set_used_heap_size(allocator->GetUsedBytes());
+}
 /*static*/ void V8::VisitExternalResources(ExternalResourceVisitor* visitor) { TODO(); }
 /*static*/ void V8::VisitHandlesWithClassIds(PersistentHandleVisitor* visitor) { TODO(); }
 /*static*/ bool V8::IdleNotification(int hint) { TODO(); return false; }
@@ -45,4 +45,13 @@
 	if (shell_err) { XCTFail(@"%d", shell_err); }
 }
 
+- (void)testBench
+{
+	extern int bench_main(int argc, char* argv[]);
+	const char* bench_argv[] = { "bench" };
+	const int bench_argc = sizeof(bench_argv)/sizeof(bench_argv[0]);
+	int bench_err = bench_main(bench_argc, (char**) bench_argv);
+	if (bench_err) { XCTFail(@"%d", bench_err); }
+}
+
 @end